@@ -0,0 +1,84 @@
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+#include <cstdlib>
+#include <new>
+
+#include <sys/mman.h>
+
+#include "Array.h"
+
+template<typename T>
+struct AllocationResult {
+    T* ptr;
+    size_t count;
+};
+
+// Allocator for SIMD kernels. Buffers start on an Alignment boundary and their byte size is
+// rounded up to a multiple of Alignment; allocate_at_least() reports the rounded element count,
+// so Array::capacity() covers the padding and full-width vector loads up to capacity() stay
+// inside the buffer. With HugePages, buffers of at least hugePageSize bytes are aligned and
+// rounded to huge pages and advised with MADV_HUGEPAGE to cut TLB misses.
+template<typename T, size_t Alignment = 64, bool HugePages = false>
+struct AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0 && Alignment >= alignof(T), "Alignment must be a power of two not below alignof(T)");
+
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, HugePages>;
+    };
+
+    static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, HugePages>&) {}
+
+    T* allocate(size_t n);
+    AllocationResult<T> allocate_at_least(size_t n);
+    void deallocate(T* ptr, size_t n);
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment, HugePages>&) const { return true; }
+};
+
+template<typename T, size_t Alignment, bool HugePages>
+inline T* AlignedAllocator<T, Alignment, HugePages>::allocate(size_t n) {
+    return allocate_at_least(n).ptr;
+}
+
+template<typename T, size_t Alignment, bool HugePages>
+inline AllocationResult<T> AlignedAllocator<T, Alignment, HugePages>::allocate_at_least(size_t n) {
+    size_t alignment = Alignment;
+    size_t bytes = sizeof(T) * n;
+    if (HugePages && bytes >= hugePageSize) {
+        alignment = hugePageSize;
+    }
+    bytes = (bytes + alignment - 1) / alignment * alignment;
+    if (bytes == 0) {
+        bytes = alignment;
+    }
+
+    T* ptr = (T*)aligned_alloc(alignment, bytes);
+    if (ptr == nullptr) throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+    if (alignment == hugePageSize) {
+        // only a hint, the kernel falls back to normal pages when THP is unavailable
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return { ptr, bytes / sizeof(T) };
+}
+
+template<typename T, size_t Alignment, bool HugePages>
+inline void AlignedAllocator<T, Alignment, HugePages>::deallocate(T* ptr, size_t) {
+    free(ptr);
+}
+
+template<typename T, size_t Alignment = 64, bool HugePages = false>
+using AlignedArray = Array<T, DoublingGrowth, AlignedAllocator<T, Alignment, HugePages>>;
+
+#endif // ALIGNEDALLOCATOR_H
@@ -0,0 +1,191 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <new>
+#include <memory_resource>
+
+// Monotonic arena. Allocations are carved out of large blocks with a bump pointer and are
+// only given back all at once by release(). The most recent allocation can still be freed
+// or grown in place, which is what Array::reserve hits when it is the last array to grow.
+// Arena is a std::pmr::memory_resource, so it can also back PmrArray.
+class Arena final : public std::pmr::memory_resource {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    Arena(const Arena& other) = delete;
+    ~Arena();
+
+    Arena& operator=(const Arena& other) = delete;
+
+    void* reallocate(void* ptr, size_t oldBytes, size_t newBytes, size_t alignment);
+    void release();
+
+    size_t used() const;
+    size_t blockCount() const;
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    void addBlock(size_t minBytes);
+
+    size_t blockSize_;
+    Block* head_;
+    char* cur_;
+    char* end_;
+    char* last_;
+    size_t used_;
+};
+
+// std::allocator_traits compatible handle to an Arena. Copies share the arena.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena* arena);
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other);
+
+    T* allocate(size_t n);
+    void deallocate(T* ptr, size_t n);
+    T* reallocate(T* ptr, size_t oldCapacity, size_t newCapacity);
+
+    Arena* arena() const;
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+
+private:
+    Arena* arena_;
+};
+
+inline Arena::Arena(size_t blockSize) : blockSize_(blockSize), head_(nullptr), cur_(nullptr), end_(nullptr), last_(nullptr), used_(0) {
+}
+
+inline Arena::~Arena() {
+    while (head_) {
+        Block* next = head_->next;
+        free(head_);
+        head_ = next;
+    }
+}
+
+inline void Arena::addBlock(size_t minBytes) {
+    size_t size = blockSize_;
+    if (size < minBytes + alignof(std::max_align_t)) {
+        size = minBytes + alignof(std::max_align_t);
+    }
+    Block* block = (Block*)malloc(sizeof(Block) + size);
+    if (block == nullptr) throw std::bad_alloc();
+
+    block->next = head_;
+    block->size = size;
+    head_ = block;
+    cur_ = (char*)(block + 1);
+    end_ = cur_ + size;
+    last_ = nullptr;
+}
+
+inline void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t p = ((uintptr_t)cur_ + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (head_ == nullptr || p + bytes > (uintptr_t)end_) {
+        addBlock(bytes + alignment);
+        p = ((uintptr_t)cur_ + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    last_ = (char*)p;
+    cur_ = last_ + bytes;
+    used_ += bytes;
+    return last_;
+}
+
+inline void Arena::do_deallocate(void* ptr, size_t bytes, size_t) {
+    if (ptr != nullptr && ptr == last_) {
+        cur_ = last_;
+        last_ = nullptr;
+        used_ -= bytes;
+    }
+}
+
+inline bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+inline void* Arena::reallocate(void* ptr, size_t oldBytes, size_t newBytes, size_t alignment) {
+    if (ptr != nullptr && ptr == last_ && last_ + newBytes <= end_) {
+        cur_ = last_ + newBytes;
+        used_ += newBytes - oldBytes;
+        return ptr;
+    }
+    void* newPtr = allocate(newBytes, alignment);
+    if (ptr != nullptr) {
+        std::memcpy(newPtr, ptr, oldBytes < newBytes ? oldBytes : newBytes);
+    }
+    return newPtr;
+}
+
+inline void Arena::release() {
+    // keep the oldest block around so the next batch does not have to hit malloc
+    while (head_ && head_->next) {
+        Block* next = head_->next;
+        free(head_);
+        head_ = next;
+    }
+    if (head_) {
+        cur_ = (char*)(head_ + 1);
+        end_ = cur_ + head_->size;
+    }
+    last_ = nullptr;
+    used_ = 0;
+}
+
+inline size_t Arena::used() const {
+    return used_;
+}
+
+inline size_t Arena::blockCount() const {
+    size_t count = 0;
+    for (Block* block = head_; block; block = block->next) {
+        count++;
+    }
+    return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+inline ArenaAllocator<T>::ArenaAllocator(Arena* arena) : arena_(arena) {}
+
+template<typename T>
+template<typename U>
+inline ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+template<typename T>
+inline T* ArenaAllocator<T>::allocate(size_t n) {
+    return (T*)arena_->allocate(sizeof(T) * n, alignof(T));
+}
+
+template<typename T>
+inline void ArenaAllocator<T>::deallocate(T* ptr, size_t n) {
+    arena_->deallocate(ptr, sizeof(T) * n, alignof(T));
+}
+
+template<typename T>
+inline T* ArenaAllocator<T>::reallocate(T* ptr, size_t oldCapacity, size_t newCapacity) {
+    return (T*)arena_->reallocate(ptr, sizeof(T) * oldCapacity, sizeof(T) * newCapacity, alignof(T));
+}
+
+template<typename T>
+inline Arena* ArenaAllocator<T>::arena() const {
+    return arena_;
+}
+
+#endif // ARENA_H
@@ -2,26 +2,154 @@
 #define ARRAY_H
 
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <concepts>
 #include <string>
+#include <iterator>
+#include <type_traits>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+#include "ArrayStats.h"
+
+#ifndef ARRAY_CHECKED_ITERATORS
+#ifdef NDEBUG
+#define ARRAY_CHECKED_ITERATORS 0
+#else
+#define ARRAY_CHECKED_ITERATORS 1
+#endif
+#endif
+
+// Growth policies decide the capacity push_back and insert reallocate to.
+// grow() must return a value of at least `required`.
+struct DoublingGrowth {
+    static size_t grow(size_t capacity, size_t required, size_t elementSize);
+};
+
+struct HalfGrowth {
+    static size_t grow(size_t capacity, size_t required, size_t elementSize);
+};
+
+struct PageGrowth {
+    static constexpr size_t pageSize = 4096;
+
+    static size_t grow(size_t capacity, size_t required, size_t elementSize);
+};
+
+inline size_t DoublingGrowth::grow(size_t capacity, size_t required, size_t) {
+    size_t newCapacity = capacity == 0 ? 16 : capacity * 2;
+    return newCapacity < required ? required : newCapacity;
+}
+
+inline size_t HalfGrowth::grow(size_t capacity, size_t required, size_t) {
+    size_t newCapacity = capacity < 16 ? 16 : capacity + capacity / 2;
+    return newCapacity < required ? required : newCapacity;
+}
+
+inline size_t PageGrowth::grow(size_t capacity, size_t required, size_t elementSize) {
+    size_t newCapacity = DoublingGrowth::grow(capacity, required, elementSize);
+    size_t bytes = newCapacity * elementSize;
+    if (bytes < pageSize) return newCapacity;
+    bytes = (bytes + pageSize - 1) / pageSize * pageSize;
+    return bytes / elementSize;
+}
+
+// Types for which moving an object to a new address is equivalent to copying its bytes.
+// Specialize for types that are not trivially copyable but can still be relocated with memcpy.
+template<typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Default allocator. Besides the std::allocator_traits interface it provides reallocate(),
+// which Array uses to grow buffers of trivially relocatable types with realloc.
+template<typename T>
+struct MallocAllocator {
+    using value_type = T;
+
+    MallocAllocator() = default;
+    template<typename U>
+    MallocAllocator(const MallocAllocator<U>&) {}
+
+    T* allocate(size_t n);
+    void deallocate(T* ptr, size_t n);
+    T* reallocate(T* ptr, size_t oldCapacity, size_t newCapacity);
+
+    template<typename U>
+    bool operator==(const MallocAllocator<U>&) const { return true; }
+};
+
+template<typename T>
+inline T* MallocAllocator<T>::allocate(size_t n) {
+    T* ptr = (T*)malloc(sizeof(T) * n);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+template<typename T>
+inline void MallocAllocator<T>::deallocate(T* ptr, size_t) {
+    free(ptr);
+}
+
+template<typename T>
+inline T* MallocAllocator<T>::reallocate(T* ptr, size_t, size_t newCapacity) {
+    T* newPtr = (T*)realloc(ptr, sizeof(T) * newCapacity);
+    if (newPtr == nullptr) throw std::bad_alloc();
+    return newPtr;
+}
+
+// Uninitialized room for N elements kept inside the Array object itself.
+template<typename T, size_t N>
+struct InlineStorage {
+    InlineStorage() {}
+
+    T* data() { return reinterpret_cast<T*>(bytes_); }
+    const T* data() const { return reinterpret_cast<const T*>(bytes_); }
+
+    alignas(T) unsigned char bytes_[sizeof(T) * N];
+};
 
 template<typename T>
+struct InlineStorage<T, 0> {
+    T* data() { return nullptr; }
+    const T* data() const { return nullptr; }
+};
+
+// N > 0 keeps the first N elements inline and only spills to Alloc once the array outgrows them.
+template<typename T, typename Growth = DoublingGrowth, typename Alloc = MallocAllocator<T>, size_t N = 0>
 class Array final {
 public:
     using size_type = size_t;
+    using allocator_type = Alloc;
 
     Array();
-    Array(size_type capacity);
-    Array(std::initializer_list<T> const& items);
+    explicit Array(const Alloc& alloc);
+    Array(size_type capacity, const Alloc& alloc = Alloc());
+    Array(std::initializer_list<T> const& items, const Alloc& alloc = Alloc());
     Array(const Array& other);
     Array(Array&& other);
     ~Array();
 
     void reserve(size_type newCapacity);
     size_type push_back(const T& value);
+    size_type push_back(T&& value);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
     size_type insert(size_type index, const T& value);
 
+    template<std::input_iterator InputIt>
+    void append(InputIt first, InputIt last);
+    template<std::input_iterator InputIt>
+    void assign(InputIt first, InputIt last);
+    void assign(size_type count, const T& value);
+    void resize(size_type newSize);
+    void resize_for_overwrite(size_type newSize);
+    void resize(size_type newSize, const T& value);
+    void clear();
+
     void remove(size_type index);
 
     const T& operator[](size_type index) const;
@@ -33,15 +161,24 @@ public:
     size_type size() const;
     size_type capacity() const;
 
+    T* data();
+    const T* data() const;
+    Alloc get_allocator() const;
+
+    class ConstIterator;
+
     class Iterator {
     public:
+        using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept = std::contiguous_iterator_tag;
         using value_type = T;
         using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
 
         Iterator();
-        Iterator(size_type index, Array* array);
-        Iterator(const Iterator& other);
-        Iterator(Iterator&& other);
+        Iterator(T* ptr, Array* array);
+        Iterator(const Iterator& other) = default;
 
         const T& get() const;
         void set(const T& value);
@@ -60,28 +197,40 @@ public:
         Iterator operator--(int);
         T& operator*() const;
         T* operator->() const;
-        Iterator& operator=(const Iterator& other);
+        Iterator& operator=(const Iterator& other) = default;
         Iterator& operator+=(ptrdiff_t n);
         Iterator& operator-=(ptrdiff_t n);
         ptrdiff_t operator-(const Iterator& other) const;
         Iterator operator-(ptrdiff_t n) const;
         Iterator operator+(ptrdiff_t n) const;
-        T& operator[](ptrdiff_t n);
+        T& operator[](ptrdiff_t n) const;
+
+        friend Iterator operator+(ptrdiff_t n, const Iterator& iter) {
+            return iter + n;
+        }
 
     private:
-        size_type index_;
+        friend class ConstIterator;
+
+        void check(const T* ptr) const;
+
+        T* ptr_;
         Array* array_;
     };
 
     class ConstIterator {
     public:
+        using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept = std::contiguous_iterator_tag;
         using value_type = T;
         using difference_type = ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
 
         ConstIterator();
-        ConstIterator(size_type index, const Array* array);
-        ConstIterator(const ConstIterator& other);
-        ConstIterator(ConstIterator&& other);
+        ConstIterator(const T* ptr, const Array* array);
+        ConstIterator(const ConstIterator& other) = default;
+        ConstIterator(const Iterator& other);
 
         const T& get() const;
         void next();
@@ -99,15 +248,22 @@ public:
         ConstIterator operator--(int);
         const T& operator*() const;
         const T* operator->() const;
-        ConstIterator& operator=(const ConstIterator& other);
+        ConstIterator& operator=(const ConstIterator& other) = default;
         ConstIterator& operator+=(ptrdiff_t n);
         ConstIterator& operator-=(ptrdiff_t n);
         ptrdiff_t operator-(const ConstIterator& other) const;
         ConstIterator operator-(ptrdiff_t n) const;
         ConstIterator operator+(ptrdiff_t n) const;
         const T& operator[](ptrdiff_t n) const;
+
+        friend ConstIterator operator+(ptrdiff_t n, const ConstIterator& iter) {
+            return iter + n;
+        }
+
     private:
-        size_type index_;
+        void check(const T* ptr) const;
+
+        const T* ptr_;
         const Array* array_;
     };
 
@@ -122,556 +278,860 @@ public:
 
     Iterator reverseIterator();
     ConstIterator reverseIterator() const;
+
+    template<std::input_iterator InputIt>
+    size_type insert(size_type index, InputIt first, InputIt last);
+    Iterator erase(ConstIterator first, ConstIterator last);
+    template<typename Pred>
+    Iterator remove_if(Pred pred);
+    template<typename Pred>
+    size_type erase_if(Pred pred);
 private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>, "Alloc::value_type must be T");
+
+    T* allocateAtLeast(size_type& count);
+    void release();
+    bool isInline() const;
+
+    // declared first so buf_ can point into it from the member initializers
+    [[no_unique_address]] InlineStorage<T, N> inline_;
     size_type capacity_;
     size_type size_;
     T* buf_;
+    [[no_unique_address]] Alloc alloc_;
 };
 
 template<typename T>
-inline Array<T>::Array() : capacity_(0), size_(0), buf_(nullptr) {
+using PmrArray = Array<T, DoublingGrowth, std::pmr::polymorphic_allocator<T>>;
+
+template<typename T, size_t N, typename Growth = DoublingGrowth, typename Alloc = MallocAllocator<T>>
+using SmallArray = Array<T, Growth, Alloc, N>;
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Array() : capacity_(N), size_(0), buf_(inline_.data()), alloc_() {
 }
 
-template<typename T>
-inline Array<T>::Array(size_type capacity) : capacity_(capacity), size_(capacity), buf_(nullptr) {
-    if ((capacity_ != 0) && !(buf_ = (T*)malloc(sizeof(T) * capacity_))) {
-        throw std::bad_alloc();
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Array(const Alloc& alloc) : capacity_(N), size_(0), buf_(inline_.data()), alloc_(alloc) {
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Array(size_type capacity, const Alloc& alloc) : capacity_(N), size_(capacity), buf_(inline_.data()), alloc_(alloc) {
+    if (capacity > N) {
+        capacity_ = capacity;
+        buf_ = allocateAtLeast(capacity_);
     }
 }
 
-template<typename T>
-inline Array<T>::Array(std::initializer_list<T> const& items) : capacity_(items.size()), size_(items.size()), buf_(nullptr) {
-    if (!(buf_ = (T*)malloc(sizeof(T) * capacity_))) {
-        throw std::bad_alloc();
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Array(std::initializer_list<T> const& items, const Alloc& alloc) : capacity_(N), size_(items.size()), buf_(inline_.data()), alloc_(alloc) {
+    if (items.size() > N) {
+        capacity_ = items.size();
+        buf_ = allocateAtLeast(capacity_);
     }
     size_t i = 0;
     for (const auto& item : items) {
-        new(&buf_[i++]) T(item);
+        alloc_traits::construct(alloc_, &buf_[i++], item);
     }
 }
 
-template<typename T>
-inline Array<T>::Array(const Array& other) : capacity_(0), size_(0), buf_(nullptr) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Array(const Array& other)
+    : capacity_(N), size_(0), buf_(inline_.data()), alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
     *this = other;
 }
 
-template<typename T>
-inline Array<T>::Array(Array&& other) : capacity_(0), size_(0), buf_(nullptr) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Array(Array&& other) : capacity_(N), size_(0), buf_(inline_.data()), alloc_(std::move(other.alloc_)) {
     *this = std::move(other);
 }
 
-template<typename T>
-inline Array<T>::~Array() {
-    if (buf_) {
-        for (size_type i = 0; i < size_; i++) {
-            buf_[i].~T();
-        }
-        free(buf_);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::~Array() {
+    release();
+}
+
+// Allocators may hand out more room than asked for (alignment padding, whole pages) through
+// allocate_at_least(); count is updated so that capacity() reports all of it.
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline T* Array<T, Growth, Alloc, N>::allocateAtLeast(size_type& count) {
+    if constexpr (requires { alloc_.allocate_at_least(count); }) {
+        auto result = alloc_.allocate_at_least(count);
+        count = result.count;
+        ARRAY_STATS_ADD(T, allocations, 1);
+        ARRAY_STATS_ADD(T, bytesAllocated, sizeof(T) * count);
+        ARRAY_STATS_PEAK(T, sizeof(T) * count);
+        return result.ptr;
+    } else {
+        T* ptr = alloc_traits::allocate(alloc_, count);
+        ARRAY_STATS_ADD(T, allocations, 1);
+        ARRAY_STATS_ADD(T, bytesAllocated, sizeof(T) * count);
+        ARRAY_STATS_PEAK(T, sizeof(T) * count);
+        return ptr;
     }
 }
 
-template<typename T>
-inline void Array<T>::reserve(size_type newCapacity) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::release() {
+    for (size_type i = 0; i < size_; i++) {
+        alloc_traits::destroy(alloc_, &buf_[i]);
+    }
+    if (buf_ && !isInline()) {
+        ARRAY_STATS_ADD(T, wastedBytes, sizeof(T) * (capacity_ - size_));
+        alloc_traits::deallocate(alloc_, buf_, capacity_);
+    }
+    capacity_ = N;
+    size_ = 0;
+    buf_ = inline_.data();
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::isInline() const {
+    return N != 0 && buf_ == inline_.data();
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::reserve(size_type newCapacity) {
     if (newCapacity == 0) {
-        newCapacity = 16;
+        newCapacity = Growth::grow(0, 1, sizeof(T));
     }
     if (newCapacity > capacity_) {
-        T* ptr = (T*)malloc(sizeof(T) * newCapacity);
-
-        if (ptr == nullptr) throw std::bad_alloc();
+        T* ptr;
 
         if (buf_ != nullptr) {
-            for (size_type i = 0; i < size_; i++) {
-                if (std::movable<T>) {
-                    new (&ptr[i]) T(std::move(buf_[i]));
-                    buf_[i].~T();
+            ARRAY_STATS_ADD(T, reallocations, 1);
+            ARRAY_STATS_ADD(T, bytesMoved, sizeof(T) * size_);
+            if (!isInline()) ARRAY_STATS_ADD(T, wastedBytes, sizeof(T) * (capacity_ - size_));
+        }
+
+        if constexpr (is_trivially_relocatable_v<T> && requires { alloc_.reallocate(buf_, capacity_, newCapacity); }) {
+            if (isInline()) {
+                ptr = allocateAtLeast(newCapacity);
+                std::memcpy((void*)ptr, (const void*)buf_, sizeof(T) * size_);
+            } else {
+                // the allocator may extend the block in place and otherwise copies the bytes for us
+                ptr = alloc_.reallocate(buf_, capacity_, newCapacity);
+                if (buf_ == nullptr) ARRAY_STATS_ADD(T, allocations, 1);
+                ARRAY_STATS_ADD(T, bytesAllocated, sizeof(T) * newCapacity);
+                ARRAY_STATS_PEAK(T, sizeof(T) * newCapacity);
+            }
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            ptr = allocateAtLeast(newCapacity);
+
+            if (buf_ != nullptr) {
+                std::memcpy((void*)ptr, (const void*)buf_, sizeof(T) * size_);
+                if (!isInline()) alloc_traits::deallocate(alloc_, buf_, capacity_);
+            }
+        } else {
+            ptr = allocateAtLeast(newCapacity);
+
+            if (buf_ != nullptr) {
+                if constexpr (std::movable<T>) {
+                    ARRAY_STATS_ADD(T, moves, size_);
                 } else {
-                    new (&ptr[i]) T(buf_[i]);
-                    buf_[i].~T();
+                    ARRAY_STATS_ADD(T, copies, size_);
+                }
+                for (size_type i = 0; i < size_; i++) {
+                    if constexpr (std::movable<T>) {
+                        alloc_traits::construct(alloc_, &ptr[i], std::move(buf_[i]));
+                        alloc_traits::destroy(alloc_, &buf_[i]);
+                    } else {
+                        alloc_traits::construct(alloc_, &ptr[i], buf_[i]);
+                        alloc_traits::destroy(alloc_, &buf_[i]);
+                    }
                 }
+                if (!isInline()) alloc_traits::deallocate(alloc_, buf_, capacity_);
             }
-            free(buf_);
         }
         buf_ = ptr;
         capacity_ = newCapacity;
     }
 }
 
-template<typename T>
-inline typename Array<T>::size_type Array<T>::push_back(const T& value) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::push_back(const T& value) {
+    ARRAY_STATS_ADD(T, copies, 1);
+    emplace_back(value);
+    return size_ - 1;
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::push_back(T&& value) {
+    ARRAY_STATS_ADD(T, moves, 1);
+    emplace_back(std::move(value));
+    return size_ - 1;
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+template<typename... Args>
+inline T& Array<T, Growth, Alloc, N>::emplace_back(Args&&... args) {
     if (capacity_ == size_) {
-        reserve(capacity_ * 2);
+        // args may refer to an element of this array, so build the value before reallocating
+        T value(std::forward<Args>(args)...);
+        reserve(Growth::grow(capacity_, size_ + 1, sizeof(T)));
+        alloc_traits::construct(alloc_, &buf_[size_], std::move(value));
+    } else {
+        alloc_traits::construct(alloc_, &buf_[size_], std::forward<Args>(args)...);
+    }
+    return buf_[size_++];
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+template<std::input_iterator InputIt>
+inline void Array<T, Growth, Alloc, N>::append(InputIt first, InputIt last) {
+    // sized input iterators (std::move_iterator over a pointer) are counted up front as well
+    if constexpr (std::forward_iterator<InputIt> || std::sized_sentinel_for<InputIt, InputIt>) {
+        size_type count = std::distance(first, last);
+        if (size_ + count > capacity_) {
+            if constexpr (std::contiguous_iterator<InputIt>) {
+                // the source range may live in this array and would dangle when it reallocates
+                const T* src = std::to_address(first);
+                if (count != 0 && src >= buf_ && src < buf_ + size_) {
+                    Array tmp(alloc_);
+                    tmp.append(first, last);
+                    append(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+                    return;
+                }
+            }
+            reserve(Growth::grow(capacity_, size_ + count, sizeof(T)));
+        }
+        ARRAY_STATS_ADD(T, copies, count);
+        for (; first != last; ++first) {
+            alloc_traits::construct(alloc_, &buf_[size_++], *first);
+        }
+    } else {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
     }
-    
-    new (&buf_[size_++]) T(value);
-    return size_ - 1;
 }
 
-template<typename T>
-inline typename Array<T>::size_type Array<T>::insert(size_type index, const T& value) {
-    if (index == size_) {
-        push_back(value);
-    } else if (index > size_) {
-        throw std::out_of_range("");
+template<typename T, typename Growth, typename Alloc, size_t N>
+template<std::input_iterator InputIt>
+inline void Array<T, Growth, Alloc, N>::assign(InputIt first, InputIt last) {
+    if constexpr (std::contiguous_iterator<InputIt>) {
+        // clear() would destroy a source range that lives in this array
+        const T* src = std::to_address(first);
+        if (first != last && src >= buf_ && src < buf_ + size_) {
+            Array tmp(alloc_);
+            tmp.append(first, last);
+            clear();
+            append(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+            return;
+        }
+    }
+    clear();
+    append(first, last);
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::assign(size_type count, const T& value) {
+    if (std::addressof(value) >= buf_ && std::addressof(value) < buf_ + size_) {
+        // value is an element of this array, which clear() destroys
+        T copy(value);
+        clear();
+        resize(count, copy);
+        return;
+    }
+    clear();
+    resize(count, value);
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::resize(size_type newSize) {
+    if (newSize <= size_) {
+        for (size_type i = newSize; i < size_; i++) {
+            alloc_traits::destroy(alloc_, &buf_[i]);
+        }
+        size_ = newSize;
+        return;
+    }
+    if (newSize > capacity_) {
+        reserve(newSize);
+    }
+    while (size_ < newSize) {
+        alloc_traits::construct(alloc_, &buf_[size_++]);
+    }
+}
+
+// Like resize(), but new elements are default-initialized, so trivial types are left
+// uninitialized for the caller to fill in (e.g. straight from a read()).
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::resize_for_overwrite(size_type newSize) {
+    if (newSize <= size_) {
+        for (size_type i = newSize; i < size_; i++) {
+            alloc_traits::destroy(alloc_, &buf_[i]);
+        }
+        size_ = newSize;
+        return;
+    }
+    if (newSize > capacity_) {
+        reserve(newSize);
+    }
+    if constexpr (std::is_trivially_default_constructible_v<T>) {
+        size_ = newSize;
     } else {
-        if (capacity_ == size_) {
-            reserve(capacity_ * 2);
+        while (size_ < newSize) {
+            ::new ((void*)&buf_[size_++]) T;
         }
-        for (size_type i = size_; i > index; i--) {
-            if (std::movable<T>) {
-                new (&buf_[i]) T(std::move(buf_[i - 1]));
-            } else {
-                new (&buf_[i]) T(buf_[i - 1]);
-            }
+    }
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::resize(size_type newSize, const T& value) {
+    if (newSize <= size_) {
+        for (size_type i = newSize; i < size_; i++) {
+            alloc_traits::destroy(alloc_, &buf_[i]);
         }
-        new (&buf_[index]) T(value);
-        size_++;
+        size_ = newSize;
+        return;
+    }
+    if (newSize > capacity_) {
+        // value may refer to an element of this array
+        T copy(value);
+        reserve(newSize);
+        while (size_ < newSize) {
+            alloc_traits::construct(alloc_, &buf_[size_++], copy);
+        }
+    }
+    while (size_ < newSize) {
+        alloc_traits::construct(alloc_, &buf_[size_++], value);
     }
-    return index;
 }
 
-template<typename T>
-inline void Array<T>::remove(size_type index) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::clear() {
+    while (size_ > 0) {
+        alloc_traits::destroy(alloc_, &buf_[--size_]);
+    }
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::insert(size_type index, const T& value) {
+    return insert(index, &value, &value + 1);
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::remove(size_type index) {
     if (index >= size_) {
         throw std::out_of_range("");
-    } else if (index == size_ - 1) {
-        buf_[index].~T();
+    }
+    erase(ConstIterator(buf_ + index, this), ConstIterator(buf_ + index + 1, this));
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+template<std::input_iterator InputIt>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::insert(size_type index, InputIt first, InputIt last) {
+    if (index > size_) {
+        throw std::out_of_range("");
+    }
+    if constexpr (!std::forward_iterator<InputIt>) {
+        Array tmp(alloc_);
+        tmp.append(first, last);
+        return insert(index, tmp.begin(), tmp.end());
     } else {
-        for (size_type i = index; i < size_ - 1; i++) {
-            if (std::movable<T>) {
-                new (&buf_[i]) T(std::move(buf_[i + 1]));
+        if constexpr (std::contiguous_iterator<InputIt>) {
+            // the source range may live in this array and would move or dangle while we shift
+            const T* src = std::to_address(first);
+            if (first != last && src >= buf_ && src < buf_ + size_) {
+                Array tmp(alloc_);
+                tmp.append(first, last);
+                return insert(index, tmp.begin(), tmp.end());
             }
-            else {
-                new (&buf_[i]) T(buf_[i - 1]);
+        }
+
+        size_type count = std::distance(first, last);
+        if (count == 0) return index;
+        if (size_ + count > capacity_) {
+            reserve(Growth::grow(capacity_, size_ + count, sizeof(T)));
+        }
+
+        ARRAY_STATS_ADD(T, copies, count);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            // open the gap with one memmove, it is raw memory afterwards
+            ARRAY_STATS_ADD(T, bytesMoved, sizeof(T) * (size_ - index));
+            std::memmove((void*)(buf_ + index + count), (const void*)(buf_ + index), sizeof(T) * (size_ - index));
+            for (size_type i = index; first != last; ++first, ++i) {
+                alloc_traits::construct(alloc_, &buf_[i], *first);
+            }
+        } else {
+            ARRAY_STATS_ADD(T, moves, size_ - index);
+            for (size_type i = size_; i-- > index; ) {
+                if (i + count >= size_) {
+                    alloc_traits::construct(alloc_, &buf_[i + count], std::move(buf_[i]));
+                } else {
+                    buf_[i + count] = std::move(buf_[i]);
+                }
+            }
+            for (size_type i = index; first != last; ++first, ++i) {
+                if (i < size_) {
+                    buf_[i] = *first;
+                } else {
+                    alloc_traits::construct(alloc_, &buf_[i], *first);
+                }
             }
         }
-        buf_[size_ - 1].~T();
+        size_ += count;
     }
-    size_--;
+    return index;
 }
 
-template<typename T>
-inline const T& Array<T>::operator[](size_type index) const {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::erase(ConstIterator first, ConstIterator last) {
+    size_type from = first - cbegin();
+    size_type to = last - cbegin();
+    if (from > to || to > size_) {
+        throw std::out_of_range("");
+    }
+    size_type count = to - from;
+
+    if constexpr (is_trivially_relocatable_v<T>) {
+        for (size_type i = from; i < to; i++) {
+            alloc_traits::destroy(alloc_, &buf_[i]);
+        }
+        ARRAY_STATS_ADD(T, bytesMoved, sizeof(T) * (size_ - to));
+        std::memmove((void*)(buf_ + from), (const void*)(buf_ + to), sizeof(T) * (size_ - to));
+        size_ -= count;
+    } else {
+        ARRAY_STATS_ADD(T, moves, size_ - to);
+        std::move(buf_ + to, buf_ + size_, buf_ + from);
+        while (count-- > 0) {
+            alloc_traits::destroy(alloc_, &buf_[--size_]);
+        }
+    }
+    return Iterator(buf_ + from, this);
+}
+
+// Moves the elements that do not match pred to the front, keeping their order, and returns
+// the new logical end. The elements past it are left in a moved-from state until erased.
+template<typename T, typename Growth, typename Alloc, size_t N>
+template<typename Pred>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::remove_if(Pred pred) {
+    size_type out = 0;
+    for (size_type i = 0; i < size_; i++) {
+        if (!pred(buf_[i])) {
+            if (out != i) buf_[out] = std::move(buf_[i]);
+            out++;
+        }
+    }
+    return Iterator(buf_ + out, this);
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+template<typename Pred>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::erase_if(Pred pred) {
+    size_type oldSize = size_;
+    erase(remove_if(pred), end());
+    return oldSize - size_;
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T& Array<T, Growth, Alloc, N>::operator[](size_type index) const {
     if (index >= size_) {
         throw std::out_of_range("Index out of range");
     }
     return buf_[index];
 }
 
-template<typename T>
-inline T& Array<T>::operator[](size_type index) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline T& Array<T, Growth, Alloc, N>::operator[](size_type index) {
     if (index >= size_) {
         throw std::out_of_range("Index out of range");
     }
     return buf_[index];
 }
 
-template<typename T>
-inline Array<T>& Array<T>::operator=(const Array& other) {
-    if (buf_ != nullptr) this->~Array();
-    capacity_ = other.capacity_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>& Array<T, Growth, Alloc, N>::operator=(const Array& other) {
+    if (this == &other) return *this;
+    release();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+        alloc_ = other.alloc_;
+    }
+    if (other.capacity_ > capacity_ && other.size_ > N) {
+        capacity_ = other.capacity_;
+        buf_ = allocateAtLeast(capacity_);
+    }
     size_ = other.size_;
-
-    if (capacity_ == 0) {
-        buf_ = nullptr;
-    } else if (!(buf_ = (T*)malloc(sizeof(T) * capacity_))) {
-        throw std::bad_alloc();
-    } else {
-        for (size_type i = 0; i < size_; i++) {
-            new (&buf_[i]) T(other.buf_[i]);
-        }
+    ARRAY_STATS_ADD(T, copies, size_);
+    for (size_type i = 0; i < size_; i++) {
+        alloc_traits::construct(alloc_, &buf_[i], other.buf_[i]);
     }
     return *this;
 }
 
-template<typename T>
-inline Array<T>& Array<T>::operator=(Array&& other) {
-    if (buf_ != nullptr) this->~Array();
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>& Array<T, Growth, Alloc, N>::operator=(Array&& other) {
+    if (this == &other) return *this;
+    release();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+        alloc_ = std::move(other.alloc_);
+    }
+    if (other.isInline() || !(alloc_traits::propagate_on_container_move_assignment::value || alloc_ == other.alloc_)) {
+        // the buffer is inline or belongs to a different allocator, so only the elements can be moved
+        if (other.size_ > capacity_) reserve(other.size_);
+        ARRAY_STATS_ADD(T, moves, other.size_);
+        for (size_type i = 0; i < other.size_; i++) {
+            alloc_traits::construct(alloc_, &buf_[size_++], std::move(other.buf_[i]));
+        }
+        other.release();
+        return *this;
+    }
     capacity_ = other.capacity_;
     size_ = other.size_;
     buf_ = other.buf_;
-    other.capacity_ = 0;
+    other.capacity_ = N;
     other.size_ = 0;
-    other.buf_ = nullptr;
+    other.buf_ = other.inline_.data();
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::size_type Array<T>::size() const {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::size() const {
     return size_;
 }
 
-template<typename T>
-inline typename Array<T>::size_type Array<T>::capacity() const {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::size_type Array<T, Growth, Alloc, N>::capacity() const {
     return capacity_;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::begin() {
-    return Iterator(0, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline T* Array<T, Growth, Alloc, N>::data() {
+    return buf_;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::cbegin() const {
-    return ConstIterator(0, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T* Array<T, Growth, Alloc, N>::data() const {
+    return buf_;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::end() {
-    return Iterator(size_, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Alloc Array<T, Growth, Alloc, N>::get_allocator() const {
+    return alloc_;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::cend() const {
-    return ConstIterator(size_, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::begin() {
+    return Iterator(buf_, this);
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::iterator() {
-    return Iterator(0, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::cbegin() const {
+    return ConstIterator(buf_, this);
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::iterator() const {
-    return ConstIterator(0, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::end() {
+    return Iterator(buf_ + size_, this);
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::reverseIterator() {
-    return Iterator(size_ - 1, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::cend() const {
+    return ConstIterator(buf_ + size_, this);
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::reverseIterator() const {
-    return ConstIterator(size_ - 1, this);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::iterator() {
+    return Iterator(buf_, this);
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::iterator() const {
+    return ConstIterator(buf_, this);
+}
 
-template<typename T>
-inline Array<T>::Iterator::Iterator() : index_(0), array_(nullptr) {}
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::reverseIterator() {
+    return Iterator(buf_ + size_ - 1, this);
+}
 
-template<typename T>
-inline Array<T>::Iterator::Iterator(size_type index, Array* array) : index_(index), array_(array) {}
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::reverseIterator() const {
+    return ConstIterator(buf_ + size_ - 1, this);
+}
 
-template<typename T>
-inline Array<T>::Iterator::Iterator(const Iterator& other) : index_(other.index_), array_(other.array_) {}
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-template<typename T>
-inline Array<T>::Iterator::Iterator(Iterator&& other) : index_(other.index_), array_(other.array_) {
-    other.index_ = 0;
-    other.array_ = nullptr;
+// Iterators are plain pointers into buf_. With ARRAY_CHECKED_ITERATORS every access
+// is validated against the owning array, otherwise nothing is checked.
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Iterator::Iterator() : ptr_(nullptr), array_(nullptr) {}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::Iterator::Iterator(T* ptr, Array* array) : ptr_(ptr), array_(array) {}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::Iterator::check(const T* ptr) const {
+#if ARRAY_CHECKED_ITERATORS
+    if (array_ == nullptr || ptr < array_->buf_ || ptr >= array_->buf_ + array_->size_) {
+        throw std::out_of_range("Iterator out of range");
+    }
+#else
+    (void)ptr;
+#endif
 }
 
-template<typename T>
-inline const T& Array<T>::Iterator::get() const {
-    return (*array_)[index_];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T& Array<T, Growth, Alloc, N>::Iterator::get() const {
+    check(ptr_);
+    return *ptr_;
 }
 
-template<typename T>
-inline void Array<T>::Iterator::set(const T& value) {
-    array_[index_] = value;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::Iterator::set(const T& value) {
+    check(ptr_);
+    *ptr_ = value;
 }
 
-template<typename T>
-inline void Array<T>::Iterator::next() {
-    if (hasNext()) index_++;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::Iterator::next() {
+    if (hasNext()) ptr_++;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::hasNext() const {
-    return index_ < array_->size() - 1;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::hasNext() const {
+    return ptr_ + 1 < array_->buf_ + array_->size_;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::operator==(const Iterator& other) const {
-    return index_ == other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::operator==(const Iterator& other) const {
+    return ptr_ == other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::operator!=(const Iterator& other) const {
-    return index_ != other.index_ || array_ != other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::operator!=(const Iterator& other) const {
+    return ptr_ != other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::operator<(const Iterator& other) const {
-    return index_ < other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::operator<(const Iterator& other) const {
+    return ptr_ < other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::operator>(const Iterator& other) const {
-    return index_ > other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::operator>(const Iterator& other) const {
+    return ptr_ > other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::operator<=(const Iterator& other) const {
-    return index_ <= other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::operator<=(const Iterator& other) const {
+    return ptr_ <= other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::Iterator::operator>=(const Iterator& other) const {
-    return index_ >= other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::Iterator::operator>=(const Iterator& other) const {
+    return ptr_ >= other.ptr_;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator& Array<T>::Iterator::operator++() {
-    if (index_ < array_->size()) index_++;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator& Array<T, Growth, Alloc, N>::Iterator::operator++() {
+    ++ptr_;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::Iterator::operator++(int) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::Iterator::operator++(int) {
     Iterator iter(*this);
-    if (index_ < array_->size()) index_++;
+    ++ptr_;
     return iter;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator& Array<T>::Iterator::operator--() {
-    if (index_ > 0) {
-        index_--;
-    }
-    else if (index_ == 0) {
-        index_ = array_->size();
-    }
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator& Array<T, Growth, Alloc, N>::Iterator::operator--() {
+    --ptr_;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::Iterator::operator--(int) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::Iterator::operator--(int) {
     Iterator iter(*this);
-    if (index_ > 0) {
-        index_--;
-    }
-    else if (index_ == 0) {
-        index_ = array_->size();
-    }
+    --ptr_;
     return iter;
 }
 
-template<typename T>
-inline T& Array<T>::Iterator::operator*() const {
-    if (index_ == array_->size()) return (*array_)[index_ - 1];
-    return (*array_)[index_];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline T& Array<T, Growth, Alloc, N>::Iterator::operator*() const {
+    check(ptr_);
+    return *ptr_;
 }
 
-template<typename T>
-inline T* Array<T>::Iterator::operator->() const {
-    if (index_ == array_->size()) return &(*array_)[index_ - 1];
-    return &(*array_)[index_];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline T* Array<T, Growth, Alloc, N>::Iterator::operator->() const {
+    return ptr_;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator& Array<T>::Iterator::operator=(const Iterator& other) {
-    index_ = other.index_;
-    array_ = other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator& Array<T, Growth, Alloc, N>::Iterator::operator+=(ptrdiff_t n) {
+    ptr_ += n;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator& Array<T>::Iterator::operator+=(ptrdiff_t n) {
-    index_ += n;
-    if (index_ >= array_->size()) index_ = array_->size();
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator& Array<T, Growth, Alloc, N>::Iterator::operator-=(ptrdiff_t n) {
+    ptr_ -= n;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator& Array<T>::Iterator::operator-=(ptrdiff_t n) {
-    index_ -= n;
-    if (index_ >= array_->size()) index_ = array_->size();
-    return *this;
-}
-
-template<typename T>
-inline ptrdiff_t Array<T>::Iterator::operator-(const Iterator& other) const {
-    return index_ - other.index_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline ptrdiff_t Array<T, Growth, Alloc, N>::Iterator::operator-(const Iterator& other) const {
+    return ptr_ - other.ptr_;
 }
 
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::Iterator::operator-(ptrdiff_t n) const {
-    size_type newIndex = index_ - n;
-    if (newIndex > array_->size()) newIndex = array_->size();
-    return Iterator(newIndex, array_);
-}
-
-template<typename T>
-inline typename Array<T>::Iterator Array<T>::Iterator::operator+(ptrdiff_t n) const {
-    size_type newIndex = index_ + n;
-    if (newIndex > array_->size()) newIndex = array_->size();
-    return Iterator(newIndex, array_);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::Iterator::operator-(ptrdiff_t n) const {
+    return Iterator(ptr_ - n, array_);
 }
 
-template<typename T>
-inline T& Array<T>::Iterator::operator[](ptrdiff_t n) {
-    if (index_ + n >= array_->size()) return (*array_)[n - 1];
-    return (*array_)[index_ + n];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::Iterator Array<T, Growth, Alloc, N>::Iterator::operator+(ptrdiff_t n) const {
+    return Iterator(ptr_ + n, array_);
 }
 
-template<typename T>
-typename Array<T>::Iterator operator+(ptrdiff_t n, typename Array<T>::Iterator iter) {
-    return iter + n;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline T& Array<T, Growth, Alloc, N>::Iterator::operator[](ptrdiff_t n) const {
+    check(ptr_ + n);
+    return ptr_[n];
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-template<typename T>
-inline Array<T>::ConstIterator::ConstIterator() : index_(0), array_(nullptr) {}
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::ConstIterator::ConstIterator() : ptr_(nullptr), array_(nullptr) {}
 
-template<typename T>
-inline Array<T>::ConstIterator::ConstIterator(size_type index, const Array* array) : index_(index), array_(array) {}
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::ConstIterator::ConstIterator(const T* ptr, const Array* array) : ptr_(ptr), array_(array) {}
 
-template<typename T>
-inline Array<T>::ConstIterator::ConstIterator(const ConstIterator& other) : index_(other.index_), array_(other.array_) {}
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline Array<T, Growth, Alloc, N>::ConstIterator::ConstIterator(const Iterator& other) : ptr_(other.ptr_), array_(other.array_) {}
 
-template<typename T>
-inline Array<T>::ConstIterator::ConstIterator(ConstIterator&& other) : index_(other.index_), array_(other.array_) {
-    other.index_ = 0;
-    other.array_ = nullptr;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::ConstIterator::check(const T* ptr) const {
+#if ARRAY_CHECKED_ITERATORS
+    if (array_ == nullptr || ptr < array_->buf_ || ptr >= array_->buf_ + array_->size_) {
+        throw std::out_of_range("Iterator out of range");
+    }
+#else
+    (void)ptr;
+#endif
 }
 
-template<typename T>
-inline const T& Array<T>::ConstIterator::get() const {
-    return (*array_)[index_];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T& Array<T, Growth, Alloc, N>::ConstIterator::get() const {
+    check(ptr_);
+    return *ptr_;
 }
 
-template<typename T>
-inline void Array<T>::ConstIterator::next() {
-    if (hasNext()) index_++;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void Array<T, Growth, Alloc, N>::ConstIterator::next() {
+    if (hasNext()) ptr_++;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::hasNext() const {
-    return index_ < array_->size() - 1;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::hasNext() const {
+    return ptr_ + 1 < array_->buf_ + array_->size_;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::operator==(const ConstIterator& other) const {
-    return index_ == other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::operator==(const ConstIterator& other) const {
+    return ptr_ == other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::operator!=(const ConstIterator& other) const {
-    return index_ != other.index_ || array_ != other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::operator!=(const ConstIterator& other) const {
+    return ptr_ != other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::operator<(const ConstIterator& other) const {
-    return index_ < other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::operator<(const ConstIterator& other) const {
+    return ptr_ < other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::operator>(const ConstIterator& other) const {
-    return index_ > other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::operator>(const ConstIterator& other) const {
+    return ptr_ > other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::operator<=(const ConstIterator& other) const {
-    return index_ <= other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::operator<=(const ConstIterator& other) const {
+    return ptr_ <= other.ptr_;
 }
 
-template<typename T>
-inline bool Array<T>::ConstIterator::operator>=(const ConstIterator& other) const {
-    return index_ >= other.index_ && array_ == other.array_;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline bool Array<T, Growth, Alloc, N>::ConstIterator::operator>=(const ConstIterator& other) const {
+    return ptr_ >= other.ptr_;
 }
 
-
-template<typename T>
-inline typename Array<T>::ConstIterator& Array<T>::ConstIterator::operator++() {
-    if (index_ < array_->size()) index_++;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator& Array<T, Growth, Alloc, N>::ConstIterator::operator++() {
+    ++ptr_;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::ConstIterator::operator++(int) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::ConstIterator::operator++(int) {
     ConstIterator iter(*this);
-    if (index_ < array_->size()) index_++;
+    ++ptr_;
     return iter;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator& Array<T>::ConstIterator::operator--() {
-    if (index_ > 0) {
-        index_--;
-    }
-    else if (index_ == 0) {
-        index_ = array_->size();
-    }
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator& Array<T, Growth, Alloc, N>::ConstIterator::operator--() {
+    --ptr_;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::ConstIterator::operator--(int) {
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::ConstIterator::operator--(int) {
     ConstIterator iter(*this);
-    if (index_ > 0) {
-        index_--;
-    }
-    else if (index_ == 0) {
-        index_ = array_->size();
-    }
+    --ptr_;
     return iter;
 }
 
-template<typename T>
-inline const T& Array<T>::ConstIterator::operator*() const {
-    if (index_ == array_->size()) return (*array_)[index_ - 1];
-    return (*array_)[index_];
-}
-
-template<typename T>
-inline const T* Array<T>::ConstIterator::operator->() const {
-    if (index_ == array_->size()) return &(*array_)[index_ - 1];
-    return &(*array_)[index_];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T& Array<T, Growth, Alloc, N>::ConstIterator::operator*() const {
+    check(ptr_);
+    return *ptr_;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator& Array<T>::ConstIterator::operator=(const ConstIterator& other) {
-    index_ = other.index_;
-    array_ = other.array_;
-    return *this;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T* Array<T, Growth, Alloc, N>::ConstIterator::operator->() const {
+    return ptr_;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator& Array<T>::ConstIterator::operator+=(ptrdiff_t n) {
-    index_ += n;
-    if (index_ >= array_->size()) index_ = array_->size();
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator& Array<T, Growth, Alloc, N>::ConstIterator::operator+=(ptrdiff_t n) {
+    ptr_ += n;
     return *this;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator& Array<T>::ConstIterator::operator-=(ptrdiff_t n) {
-    index_ -= n;
-    if (index_ >= array_->size()) index_ = array_->size();
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator& Array<T, Growth, Alloc, N>::ConstIterator::operator-=(ptrdiff_t n) {
+    ptr_ -= n;
     return *this;
 }
 
-template<typename T>
-inline ptrdiff_t Array<T>::ConstIterator::operator-(const ConstIterator& other) const {
-    return index_ - other.index_;
-}
-
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::ConstIterator::operator-(ptrdiff_t n) const {
-    size_type newIndex = index_ - n;
-    if (newIndex > array_->size()) newIndex = array_->size();
-    return Iterator(newIndex, array_);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline ptrdiff_t Array<T, Growth, Alloc, N>::ConstIterator::operator-(const ConstIterator& other) const {
+    return ptr_ - other.ptr_;
 }
 
-template<typename T>
-inline typename Array<T>::ConstIterator Array<T>::ConstIterator::operator+(ptrdiff_t n) const {
-    size_type newIndex = index_ - n;
-    if (newIndex > array_->size()) newIndex = array_->size();
-    return Iterator(newIndex, array_);
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::ConstIterator::operator-(ptrdiff_t n) const {
+    return ConstIterator(ptr_ - n, array_);
 }
 
-template<typename T>
-inline const T& Array<T>::ConstIterator::operator[](ptrdiff_t n) const {
-    if (index_ + n >= array_->size() || index_ + n < 0) return (*array_)[n - 1];
-    return (*array_)[index_ + n];
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline typename Array<T, Growth, Alloc, N>::ConstIterator Array<T, Growth, Alloc, N>::ConstIterator::operator+(ptrdiff_t n) const {
+    return ConstIterator(ptr_ + n, array_);
 }
 
-template<typename T>
-typename Array<T>::ConstIterator operator+(ptrdiff_t n, typename Array<T>::ConstIterator iter) {
-    return iter + n;
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline const T& Array<T, Growth, Alloc, N>::ConstIterator::operator[](ptrdiff_t n) const {
+    check(ptr_ + n);
+    return ptr_[n];
 }
 
 #endif // ARRAY_H
@@ -0,0 +1,339 @@
+#ifndef ARRAYIO_H
+#define ARRAYIO_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Array.h"
+
+// Binary format for arrays of trivially copyable elements: a fixed 40-byte header followed by
+// the raw element bytes.
+//
+//     magic "ARRAYBIN" | version | byte order mark | element size | count | checksum
+//
+// writeArray() emits header and payload with a single writev, readArray() reads the payload
+// with a single read straight into the array's buffer. ArrayReader streams a file in chunks
+// for arrays that do not fit in memory. Files are only readable on machines with the same
+// byte order; the mark lets the reader reject the others instead of returning garbage.
+struct ArrayFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t elementSize;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(ArrayFileHeader) == 40);
+
+inline constexpr uint64_t arrayFileMagic = 0x4e49425941525241ull; // "ARRAYBIN"
+inline constexpr uint32_t arrayFileVersion = 1;
+inline constexpr uint32_t arrayFileByteOrder = 0x01020304;
+
+// FNV-1a over 64-bit words, so it keeps up with the disk. Bytes that do not fill a word yet
+// are kept until the next update, which makes the result independent of how the input is split.
+class ArrayChecksum {
+public:
+    ArrayChecksum();
+
+    void update(const void* data, size_t bytes);
+    uint64_t value() const;
+
+private:
+    void mix(uint64_t word);
+
+    uint64_t hash_;
+    uint64_t pending_;
+    size_t pendingBytes_;
+};
+
+inline ArrayChecksum::ArrayChecksum() : hash_(0xcbf29ce484222325ull), pending_(0), pendingBytes_(0) {
+}
+
+inline void ArrayChecksum::mix(uint64_t word) {
+    hash_ ^= word;
+    hash_ *= 0x100000001b3ull;
+}
+
+inline void ArrayChecksum::update(const void* data, size_t bytes) {
+    const unsigned char* ptr = (const unsigned char*)data;
+
+    while (pendingBytes_ != 0 && bytes > 0) {
+        pending_ |= (uint64_t)*ptr++ << (8 * pendingBytes_++);
+        bytes--;
+        if (pendingBytes_ == 8) {
+            mix(pending_);
+            pending_ = 0;
+            pendingBytes_ = 0;
+        }
+    }
+    for (; bytes >= 8; ptr += 8, bytes -= 8) {
+        uint64_t word;
+        std::memcpy(&word, ptr, 8);
+        mix(word);
+    }
+    while (bytes > 0) {
+        pending_ |= (uint64_t)*ptr++ << (8 * pendingBytes_++);
+        bytes--;
+    }
+}
+
+inline uint64_t ArrayChecksum::value() const {
+    uint64_t hash = hash_;
+    if (pendingBytes_ != 0) {
+        hash ^= pending_;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+inline void readFully(int fd, void* data, size_t bytes) {
+    char* ptr = (char*)data;
+    while (bytes > 0) {
+        ssize_t n = ::read(fd, ptr, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::system_error(errno, std::generic_category(), "ArrayIO: read failed");
+        if (n == 0) throw std::runtime_error("ArrayIO: unexpected end of file");
+        ptr += n;
+        bytes -= n;
+    }
+}
+
+inline void writeFully(int fd, const void* data, size_t bytes) {
+    const char* ptr = (const char*)data;
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, ptr, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::system_error(errno, std::generic_category(), "ArrayIO: write failed");
+        ptr += n;
+        bytes -= n;
+    }
+}
+
+inline void preadFully(int fd, void* data, size_t bytes, off_t offset) {
+    char* ptr = (char*)data;
+    while (bytes > 0) {
+        ssize_t n = ::pread(fd, ptr, bytes, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::system_error(errno, std::generic_category(), "ArrayIO: read failed");
+        if (n == 0) throw std::runtime_error("ArrayIO: unexpected end of file");
+        ptr += n;
+        bytes -= n;
+        offset += n;
+    }
+}
+
+inline ArrayFileHeader readArrayHeader(int fd, size_t elementSize) {
+    ArrayFileHeader header;
+    readFully(fd, &header, sizeof(header));
+
+    if (header.magic != arrayFileMagic || header.version != arrayFileVersion) {
+        throw std::runtime_error("ArrayIO: not an array file");
+    }
+    if (header.byteOrder != arrayFileByteOrder) {
+        throw std::runtime_error("ArrayIO: array was written with a different byte order");
+    }
+    if (header.elementSize != elementSize) {
+        throw std::runtime_error("ArrayIO: array holds elements of a different size");
+    }
+    return header;
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void writeArray(int fd, const Array<T, Growth, Alloc, N>& array) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be written as raw bytes");
+
+    size_t bytes = sizeof(T) * array.size();
+    ArrayChecksum checksum;
+    checksum.update(array.data(), bytes);
+
+    ArrayFileHeader header{};
+    header.magic = arrayFileMagic;
+    header.version = arrayFileVersion;
+    header.byteOrder = arrayFileByteOrder;
+    header.elementSize = sizeof(T);
+    header.count = array.size();
+    header.checksum = checksum.value();
+
+    iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void*)array.data();
+    iov[1].iov_len = bytes;
+
+    ssize_t n;
+    do {
+        n = ::writev(fd, iov, bytes != 0 ? 2 : 1);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw std::system_error(errno, std::generic_category(), "ArrayIO: write failed");
+    }
+
+    // a short writev (pipes, huge payloads) is finished with plain writes
+    size_t written = n;
+    if (written < sizeof(header)) {
+        writeFully(fd, (const char*)&header + written, sizeof(header) - written);
+        written = sizeof(header);
+    }
+    writeFully(fd, (const char*)array.data() + (written - sizeof(header)), bytes - (written - sizeof(header)));
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void readArray(int fd, Array<T, Growth, Alloc, N>& array) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be read as raw bytes");
+
+    ArrayFileHeader header = readArrayHeader(fd, sizeof(T));
+
+    // a corrupt count must not turn into a huge allocation: check it against what is left of
+    // the file where that is known (not for pipes)
+    if (header.count > SIZE_MAX / sizeof(T)) {
+        throw std::runtime_error("ArrayIO: element count out of range");
+    }
+    struct stat st;
+    off_t offset;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (offset = ::lseek(fd, 0, SEEK_CUR)) >= 0
+        && sizeof(T) * header.count > (uint64_t)(st.st_size - offset)) {
+        throw std::runtime_error("ArrayIO: file is shorter than its header says");
+    }
+
+    array.clear();
+    array.resize_for_overwrite(header.count);
+    try {
+        readFully(fd, array.data(), sizeof(T) * header.count);
+    } catch (...) {
+        array.clear();
+        throw;
+    }
+
+    ArrayChecksum checksum;
+    checksum.update(array.data(), sizeof(T) * header.count);
+    if (checksum.value() != header.checksum) {
+        array.clear();
+        throw std::runtime_error("ArrayIO: checksum mismatch");
+    }
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void saveArray(const std::string& path, const Array<T, Growth, Alloc, N>& array) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "ArrayIO: cannot open " + path);
+    }
+    try {
+        writeArray(fd, array);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+template<typename T, typename Growth, typename Alloc, size_t N>
+inline void loadArray(const std::string& path, Array<T, Growth, Alloc, N>& array) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "ArrayIO: cannot open " + path);
+    }
+    try {
+        readArray(fd, array);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+// Reads an array file a chunk at a time. The checksum is verified when the last chunk is read.
+template<typename T>
+class ArrayReader final {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be read as raw bytes");
+
+public:
+    using size_type = size_t;
+
+    ArrayReader(const std::string& path);
+    ArrayReader(const ArrayReader& other) = delete;
+    ~ArrayReader();
+
+    ArrayReader& operator=(const ArrayReader& other) = delete;
+
+    // Replaces the contents of chunk with up to maxCount next elements and returns how many
+    // were read, 0 once the whole array has been consumed.
+    template<typename Growth, typename Alloc, size_t N>
+    size_type read(Array<T, Growth, Alloc, N>& chunk, size_type maxCount);
+
+    size_type size() const;
+    size_type remaining() const;
+
+private:
+    int fd_;
+    ArrayFileHeader header_;
+    size_type remaining_;
+    ArrayChecksum checksum_;
+};
+
+template<typename T>
+inline ArrayReader<T>::ArrayReader(const std::string& path) : fd_(-1), header_(), remaining_(0) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "ArrayIO: cannot open " + path);
+    }
+    try {
+        header_ = readArrayHeader(fd_, sizeof(T));
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+    remaining_ = header_.count;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+template<typename T>
+inline ArrayReader<T>::~ArrayReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+template<typename T>
+template<typename Growth, typename Alloc, size_t N>
+inline typename ArrayReader<T>::size_type ArrayReader<T>::read(Array<T, Growth, Alloc, N>& chunk, size_type maxCount) {
+    size_type count = remaining_ < maxCount ? remaining_ : maxCount;
+
+    chunk.clear();
+    if (count == 0) return 0;
+    chunk.resize_for_overwrite(count);
+    readFully(fd_, chunk.data(), sizeof(T) * count);
+
+    checksum_.update(chunk.data(), sizeof(T) * count);
+    remaining_ -= count;
+    if (remaining_ == 0 && checksum_.value() != header_.checksum) {
+        throw std::runtime_error("ArrayIO: checksum mismatch");
+    }
+    return count;
+}
+
+template<typename T>
+inline typename ArrayReader<T>::size_type ArrayReader<T>::size() const {
+    return header_.count;
+}
+
+template<typename T>
+inline typename ArrayReader<T>::size_type ArrayReader<T>::remaining() const {
+    return remaining_;
+}
+
+#endif // ARRAYIO_H
@@ -0,0 +1,221 @@
+#ifndef ARRAYSTATS_H
+#define ARRAYSTATS_H
+
+// Allocation and relocation counters for Array. Compiled in only when ARRAY_STATS is defined
+// to 1; otherwise the ARRAY_STATS_* hooks expand to nothing and Array is unchanged.
+//
+// Counters are kept per element type and, while an ArrayStatsScope is alive on the current
+// thread, also under the scope's name, which is how call sites are told apart:
+//
+//     {
+//         ArrayStatsScope scope("ingest");
+//         ...
+//     }
+//     dumpArrayStats(std::cout);
+
+#ifndef ARRAY_STATS
+#define ARRAY_STATS 0
+#endif
+
+#if ARRAY_STATS
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+struct ArrayStats {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> reallocations{0};
+    std::atomic<uint64_t> bytesAllocated{0};
+    std::atomic<uint64_t> bytesMoved{0};
+    std::atomic<uint64_t> copies{0};
+    std::atomic<uint64_t> moves{0};
+    std::atomic<uint64_t> peakCapacity{0};
+    // capacity in bytes that was never used by the time its buffer was released
+    std::atomic<uint64_t> wastedBytes{0};
+
+    void reset();
+    void writeJson(std::ostream& out) const;
+};
+
+class ArrayStatsRegistry final {
+public:
+    static ArrayStatsRegistry& instance();
+
+    ArrayStats& forType(const std::type_info& type);
+    ArrayStats& forScope(const std::string& name);
+
+    static ArrayStats*& currentScope();
+
+    void reset();
+    void writeJson(std::ostream& out);
+
+private:
+    static std::string typeName(const std::type_info& type);
+
+    std::mutex mutex_;
+    std::map<std::string, ArrayStats> types_;
+    std::map<std::string, ArrayStats> scopes_;
+};
+
+class ArrayStatsScope final {
+public:
+    explicit ArrayStatsScope(const std::string& name);
+    ArrayStatsScope(const ArrayStatsScope& other) = delete;
+    ~ArrayStatsScope();
+
+    ArrayStatsScope& operator=(const ArrayStatsScope& other) = delete;
+
+private:
+    ArrayStats* previous_;
+};
+
+inline void ArrayStats::reset() {
+    allocations = 0;
+    reallocations = 0;
+    bytesAllocated = 0;
+    bytesMoved = 0;
+    copies = 0;
+    moves = 0;
+    peakCapacity = 0;
+    wastedBytes = 0;
+}
+
+inline void ArrayStats::writeJson(std::ostream& out) const {
+    out << "{\"allocations\": " << allocations
+        << ", \"reallocations\": " << reallocations
+        << ", \"bytesAllocated\": " << bytesAllocated
+        << ", \"bytesMoved\": " << bytesMoved
+        << ", \"copies\": " << copies
+        << ", \"moves\": " << moves
+        << ", \"peakCapacity\": " << peakCapacity
+        << ", \"wastedBytes\": " << wastedBytes << "}";
+}
+
+inline ArrayStatsRegistry& ArrayStatsRegistry::instance() {
+    static ArrayStatsRegistry registry;
+    return registry;
+}
+
+inline std::string ArrayStatsRegistry::typeName(const std::type_info& type) {
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    char* name = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && name != nullptr) {
+        std::string result(name);
+        free(name);
+        return result;
+    }
+#endif
+    return type.name();
+}
+
+inline ArrayStats& ArrayStatsRegistry::forType(const std::type_info& type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return types_[typeName(type)];
+}
+
+inline ArrayStats& ArrayStatsRegistry::forScope(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scopes_[name];
+}
+
+inline ArrayStats*& ArrayStatsRegistry::currentScope() {
+    thread_local ArrayStats* scope = nullptr;
+    return scope;
+}
+
+inline void ArrayStatsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [name, stats] : types_) {
+        stats.reset();
+    }
+    for (auto& [name, stats] : scopes_) {
+        stats.reset();
+    }
+}
+
+inline void ArrayStatsRegistry::writeJson(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto writeMap = [&out](const std::map<std::string, ArrayStats>& map) {
+        out << "{";
+        bool first = true;
+        for (const auto& [name, stats] : map) {
+            if (!first) out << ", ";
+            first = false;
+            out << "\"";
+            for (char c : name) {
+                if (c == '"' || c == '\\') out << '\\';
+                out << c;
+            }
+            out << "\": ";
+            stats.writeJson(out);
+        }
+        out << "}";
+    };
+    out << "{\"types\": ";
+    writeMap(types_);
+    out << ", \"scopes\": ";
+    writeMap(scopes_);
+    out << "}";
+}
+
+inline ArrayStatsScope::ArrayStatsScope(const std::string& name) : previous_(ArrayStatsRegistry::currentScope()) {
+    ArrayStatsRegistry::currentScope() = &ArrayStatsRegistry::instance().forScope(name);
+}
+
+inline ArrayStatsScope::~ArrayStatsScope() {
+    ArrayStatsRegistry::currentScope() = previous_;
+}
+
+template<typename T>
+inline ArrayStats& arrayTypeStats() {
+    static ArrayStats& stats = ArrayStatsRegistry::instance().forType(typeid(T));
+    return stats;
+}
+
+template<typename T>
+inline void arrayStatsAdd(std::atomic<uint64_t> ArrayStats::* field, uint64_t value) {
+    (arrayTypeStats<T>().*field).fetch_add(value, std::memory_order_relaxed);
+    if (ArrayStats* scope = ArrayStatsRegistry::currentScope()) {
+        (scope->*field).fetch_add(value, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+inline void arrayStatsPeak(uint64_t value) {
+    auto raise = [value](std::atomic<uint64_t>& peak) {
+        uint64_t current = peak.load(std::memory_order_relaxed);
+        while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    };
+    raise(arrayTypeStats<T>().peakCapacity);
+    if (ArrayStats* scope = ArrayStatsRegistry::currentScope()) {
+        raise(scope->peakCapacity);
+    }
+}
+
+inline void dumpArrayStats(std::ostream& out) {
+    ArrayStatsRegistry::instance().writeJson(out);
+}
+
+#define ARRAY_STATS_ADD(T, field, value) arrayStatsAdd<T>(&ArrayStats::field, (value))
+#define ARRAY_STATS_PEAK(T, bytes) arrayStatsPeak<T>(bytes)
+
+#else
+
+#define ARRAY_STATS_ADD(T, field, value) ((void)0)
+#define ARRAY_STATS_PEAK(T, bytes) ((void)0)
+
+#endif // ARRAY_STATS
+
+#endif // ARRAYSTATS_H
@@ -0,0 +1,185 @@
+#ifndef CONCURRENTARRAY_H
+#define CONCURRENTARRAY_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+// Append-only array that many threads can push_back into at the same time without locking.
+// A push reserves its slot with one fetch_add on the size and constructs the element in place.
+// Storage is a fixed table of segments whose sizes double (FirstSegment, 2 * FirstSegment, ...);
+// a missing segment is allocated by whichever thread needs it first and published with a CAS,
+// so published elements never move.
+//
+// Reading (operator[], freeze) is only safe once the producers are done, e.g. after joining them.
+// Element constructors must not throw, a failed push would leave a hole in the array.
+template<typename T, size_t FirstSegment = 1024>
+class ConcurrentArray final {
+    static_assert((FirstSegment & (FirstSegment - 1)) == 0, "FirstSegment must be a power of two");
+
+public:
+    using size_type = size_t;
+
+    ConcurrentArray();
+    ConcurrentArray(const ConcurrentArray& other) = delete;
+    ~ConcurrentArray();
+
+    ConcurrentArray& operator=(const ConcurrentArray& other) = delete;
+
+    size_type push_back(const T& value);
+    size_type push_back(T&& value);
+    template<typename... Args>
+    size_type emplace_back(Args&&... args);
+
+    const T& operator[](size_type index) const;
+    T& operator[](size_type index);
+
+    size_type size() const;
+
+    // Moves every element into a regular Array, e.g. for sorting, and empties this one.
+    Array<T> freeze();
+
+private:
+    static constexpr size_type firstShift = std::countr_zero(FirstSegment);
+    static constexpr size_type segmentCount = sizeof(size_type) * 8 - firstShift;
+
+    static size_type segmentOf(size_type index);
+    static size_type segmentSize(size_type segment);
+    static size_type offsetOf(size_type index, size_type segment);
+
+    T* segment(size_type segment);
+    T& at(size_type index);
+    void release();
+
+    std::atomic<size_type> size_;
+    std::atomic<T*> segments_[segmentCount];
+};
+
+template<typename T, size_t FirstSegment>
+inline ConcurrentArray<T, FirstSegment>::ConcurrentArray() : size_(0) {
+    for (size_type i = 0; i < segmentCount; i++) {
+        segments_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+template<typename T, size_t FirstSegment>
+inline ConcurrentArray<T, FirstSegment>::~ConcurrentArray() {
+    release();
+}
+
+template<typename T, size_t FirstSegment>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::segmentOf(size_type index) {
+    return std::bit_width(index + FirstSegment) - 1 - firstShift;
+}
+
+template<typename T, size_t FirstSegment>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::segmentSize(size_type segment) {
+    return FirstSegment << segment;
+}
+
+template<typename T, size_t FirstSegment>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::offsetOf(size_type index, size_type segment) {
+    return index + FirstSegment - segmentSize(segment);
+}
+
+template<typename T, size_t FirstSegment>
+inline T* ConcurrentArray<T, FirstSegment>::segment(size_type segment) {
+    T* ptr = segments_[segment].load(std::memory_order_acquire);
+    if (ptr != nullptr) {
+        return ptr;
+    }
+
+    T* fresh = (T*)malloc(sizeof(T) * segmentSize(segment));
+    if (fresh == nullptr) throw std::bad_alloc();
+
+    if (segments_[segment].compare_exchange_strong(ptr, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return fresh;
+    }
+    // another thread published the segment first
+    free(fresh);
+    return ptr;
+}
+
+template<typename T, size_t FirstSegment>
+inline T& ConcurrentArray<T, FirstSegment>::at(size_type index) {
+    size_type s = segmentOf(index);
+    return segments_[s].load(std::memory_order_acquire)[offsetOf(index, s)];
+}
+
+template<typename T, size_t FirstSegment>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::push_back(const T& value) {
+    return emplace_back(value);
+}
+
+template<typename T, size_t FirstSegment>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::push_back(T&& value) {
+    return emplace_back(std::move(value));
+}
+
+template<typename T, size_t FirstSegment>
+template<typename... Args>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::emplace_back(Args&&... args) {
+    size_type index = size_.fetch_add(1, std::memory_order_relaxed);
+    size_type s = segmentOf(index);
+    new (&segment(s)[offsetOf(index, s)]) T(std::forward<Args>(args)...);
+    return index;
+}
+
+template<typename T, size_t FirstSegment>
+inline const T& ConcurrentArray<T, FirstSegment>::operator[](size_type index) const {
+    return const_cast<ConcurrentArray*>(this)->operator[](index);
+}
+
+template<typename T, size_t FirstSegment>
+inline T& ConcurrentArray<T, FirstSegment>::operator[](size_type index) {
+    if (index >= size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    return at(index);
+}
+
+template<typename T, size_t FirstSegment>
+inline typename ConcurrentArray<T, FirstSegment>::size_type ConcurrentArray<T, FirstSegment>::size() const {
+    return size_.load(std::memory_order_acquire);
+}
+
+template<typename T, size_t FirstSegment>
+inline Array<T> ConcurrentArray<T, FirstSegment>::freeze() {
+    Array<T> array;
+    size_type count = size();
+    array.reserve(count);
+
+    // walk segment by segment so each one is a plain contiguous run
+    for (size_type s = 0, index = 0; index < count; s++) {
+        T* ptr = segments_[s].load(std::memory_order_acquire);
+        size_type n = std::min(segmentSize(s), count - index);
+        array.append(std::make_move_iterator(ptr), std::make_move_iterator(ptr + n));
+        index += n;
+    }
+    release();
+    return array;
+}
+
+template<typename T, size_t FirstSegment>
+inline void ConcurrentArray<T, FirstSegment>::release() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        size_type count = size();
+        for (size_type i = 0; i < count; i++) {
+            at(i).~T();
+        }
+    }
+    for (size_type s = 0; s < segmentCount; s++) {
+        free(segments_[s].exchange(nullptr, std::memory_order_acq_rel));
+    }
+    size_.store(0, std::memory_order_release);
+}
+
+#endif // CONCURRENTARRAY_H
@@ -0,0 +1,221 @@
+#ifndef COWARRAY_H
+#define COWARRAY_H
+
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+#include "Array.h"
+
+// Copy-on-write wrapper around Array. Copies share one reference-counted Array, so handing out
+// a snapshot is O(1); the first mutation through a shared copy (non-const operator[], insert,
+// remove, push_back, begin()/end(), ...) gives that copy its own private Array first.
+// Const access never copies. Use cbegin()/cend() or the const operator[] for read-only scans.
+// A mutable reference or iterator (non-const operator[], emplace_back(), begin()/end()) can be
+// written through later, so once one has been handed out the buffer is no longer shared:
+// copies taken after it copy the elements right away, until clear() drops the old ones.
+template<typename T>
+class CowArray final {
+public:
+    using size_type = typename Array<T>::size_type;
+    using Iterator = typename Array<T>::Iterator;
+    using ConstIterator = typename Array<T>::ConstIterator;
+
+    CowArray();
+    CowArray(std::initializer_list<T> const& items);
+    CowArray(const Array<T>& array);
+    CowArray(Array<T>&& array);
+    CowArray(const CowArray& other);
+    CowArray(CowArray&& other) = default;
+
+    CowArray& operator=(const CowArray& other);
+    CowArray& operator=(CowArray&& other) = default;
+
+    void reserve(size_type newCapacity);
+    size_type push_back(const T& value);
+    size_type push_back(T&& value);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+    size_type insert(size_type index, const T& value);
+    void remove(size_type index);
+    void clear();
+
+    const T& operator[](size_type index) const;
+    T& operator[](size_type index);
+
+    size_type size() const;
+    size_type capacity() const;
+    const T* data() const;
+
+    // true while another copy shares the buffer, i.e. the next mutation will copy it
+    bool shared() const;
+    const Array<T>& array() const;
+
+    Iterator begin();
+    ConstIterator cbegin() const;
+    Iterator end();
+    ConstIterator cend() const;
+
+private:
+    Array<T>& mutate();
+    // mutate() for handing out a mutable reference or iterator
+    Array<T>& mutateUnshareable();
+    std::shared_ptr<Array<T>> share() const;
+
+    std::shared_ptr<Array<T>> array_;
+    bool unshareable_ = false;
+};
+
+template<typename T>
+inline CowArray<T>::CowArray() : array_(std::make_shared<Array<T>>()) {
+}
+
+template<typename T>
+inline CowArray<T>::CowArray(std::initializer_list<T> const& items) : array_(std::make_shared<Array<T>>(items)) {
+}
+
+template<typename T>
+inline CowArray<T>::CowArray(const Array<T>& array) : array_(std::make_shared<Array<T>>(array)) {
+}
+
+template<typename T>
+inline CowArray<T>::CowArray(Array<T>&& array) : array_(std::make_shared<Array<T>>(std::move(array))) {
+}
+
+template<typename T>
+inline CowArray<T>::CowArray(const CowArray& other) : array_(other.share()) {
+}
+
+template<typename T>
+inline CowArray<T>& CowArray<T>::operator=(const CowArray& other) {
+    if (this != &other) {
+        array_ = other.share();
+        unshareable_ = false;
+    }
+    return *this;
+}
+
+template<typename T>
+inline std::shared_ptr<Array<T>> CowArray<T>::share() const {
+    if (unshareable_ && array_) {
+        return std::make_shared<Array<T>>(*array_);
+    }
+    return array_;
+}
+
+template<typename T>
+inline Array<T>& CowArray<T>::mutateUnshareable() {
+    Array<T>& array = mutate();
+    unshareable_ = true;
+    return array;
+}
+
+template<typename T>
+inline Array<T>& CowArray<T>::mutate() {
+    if (!array_) {
+        array_ = std::make_shared<Array<T>>();
+    } else if (array_.use_count() > 1) {
+        array_ = std::make_shared<Array<T>>(*array_);
+    }
+    return *array_;
+}
+
+template<typename T>
+inline void CowArray<T>::reserve(size_type newCapacity) {
+    mutate().reserve(newCapacity);
+}
+
+template<typename T>
+inline typename CowArray<T>::size_type CowArray<T>::push_back(const T& value) {
+    return mutate().push_back(value);
+}
+
+template<typename T>
+inline typename CowArray<T>::size_type CowArray<T>::push_back(T&& value) {
+    return mutate().push_back(std::move(value));
+}
+
+template<typename T>
+template<typename... Args>
+inline T& CowArray<T>::emplace_back(Args&&... args) {
+    return mutateUnshareable().emplace_back(std::forward<Args>(args)...);
+}
+
+template<typename T>
+inline typename CowArray<T>::size_type CowArray<T>::insert(size_type index, const T& value) {
+    return mutate().insert(index, value);
+}
+
+template<typename T>
+inline void CowArray<T>::remove(size_type index) {
+    mutate().remove(index);
+}
+
+template<typename T>
+inline void CowArray<T>::clear() {
+    if (array_.use_count() > 1) {
+        // nothing to copy, just stop sharing
+        array_ = std::make_shared<Array<T>>();
+    } else {
+        mutate().clear();
+    }
+    unshareable_ = false;
+}
+
+template<typename T>
+inline const T& CowArray<T>::operator[](size_type index) const {
+    return array().operator[](index);
+}
+
+template<typename T>
+inline T& CowArray<T>::operator[](size_type index) {
+    return mutateUnshareable()[index];
+}
+
+template<typename T>
+inline typename CowArray<T>::size_type CowArray<T>::size() const {
+    return array().size();
+}
+
+template<typename T>
+inline typename CowArray<T>::size_type CowArray<T>::capacity() const {
+    return array().capacity();
+}
+
+template<typename T>
+inline const T* CowArray<T>::data() const {
+    return array().data();
+}
+
+template<typename T>
+inline bool CowArray<T>::shared() const {
+    return array_.use_count() > 1;
+}
+
+template<typename T>
+inline const Array<T>& CowArray<T>::array() const {
+    static const Array<T> empty;
+    return array_ ? *array_ : empty;
+}
+
+template<typename T>
+inline typename CowArray<T>::Iterator CowArray<T>::begin() {
+    return mutateUnshareable().begin();
+}
+
+template<typename T>
+inline typename CowArray<T>::ConstIterator CowArray<T>::cbegin() const {
+    return array().cbegin();
+}
+
+template<typename T>
+inline typename CowArray<T>::Iterator CowArray<T>::end() {
+    return mutateUnshareable().end();
+}
+
+template<typename T>
+inline typename CowArray<T>::ConstIterator CowArray<T>::cend() const {
+    return array().cend();
+}
+
+#endif // COWARRAY_H
@@ -0,0 +1,437 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Array.h"
+#include "ArrayIO.h"
+#include "IntroSort.h"
+#include "ParallelSort.h"
+#include "ThreadPool.h"
+
+// Sort of array files (see ArrayIO.h) larger than memory. The input is read in chunks that fit
+// the memory budget; each chunk is sorted with ssort (the parallel one when a pool is given)
+// and written to a run file while a second thread already reads the next chunk. The runs are
+// then merged through a loser tree, every run read through its own buffer with large pread
+// calls, in as many passes as the budget needs: a pass merges at most as many runs as get a
+// buffer of EXTERNAL_SORT_MIN_BUFFER bytes. Run files are unlinked as soon as they are created,
+// so they disappear with their descriptors, also when the sort throws.
+
+// Smallest merge buffer per run; below this the disk spends its time seeking between runs.
+#define EXTERNAL_SORT_MIN_BUFFER (1 << 16)
+
+struct ExternalSortOptions {
+    // bytes of elements in memory at once: two chunks and the scratch ssort may use while runs
+    // are formed, the merge buffers afterwards
+    size_t memoryBudget = size_t(256) << 20;
+    // directory of the run files, the system temp directory when empty
+    std::string tempDir;
+    // sorts chunks with the parallel ssort when set
+    ThreadPool* pool = nullptr;
+};
+
+// Sorted run in an unlinked temp file: count raw elements from offset 0.
+class ExternalRun final {
+public:
+    explicit ExternalRun(const std::string& dir);
+    ExternalRun(const ExternalRun& other) = delete;
+    ExternalRun(ExternalRun&& other);
+    ~ExternalRun();
+
+    ExternalRun& operator=(const ExternalRun& other) = delete;
+    ExternalRun& operator=(ExternalRun&& other);
+
+    int fd() const;
+    size_t count() const;
+    void setCount(size_t count);
+
+private:
+    int fd_;
+    size_t count_;
+};
+
+inline ExternalRun::ExternalRun(const std::string& dir) : fd_(-1), count_(0) {
+    std::string path = (std::filesystem::path(dir) / "external_run_XXXXXX").string();
+    fd_ = ::mkstemp(path.data());
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "ExternalSort: cannot create a run in " + dir);
+    }
+    ::unlink(path.c_str());
+}
+
+inline ExternalRun::ExternalRun(ExternalRun&& other) : fd_(other.fd_), count_(other.count_) {
+    other.fd_ = -1;
+    other.count_ = 0;
+}
+
+inline ExternalRun::~ExternalRun() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+inline ExternalRun& ExternalRun::operator=(ExternalRun&& other) {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = std::exchange(other.fd_, -1);
+        count_ = std::exchange(other.count_, 0);
+    }
+    return *this;
+}
+
+inline int ExternalRun::fd() const {
+    return fd_;
+}
+
+inline size_t ExternalRun::count() const {
+    return count_;
+}
+
+inline void ExternalRun::setCount(size_t count) {
+    count_ = count;
+}
+
+// Reads a run a buffer at a time. done() once every element has been consumed.
+template<typename T>
+class RunReader final {
+public:
+    RunReader(const ExternalRun& run, size_t bufferCount);
+
+    bool done() const;
+    const T& current() const;
+    void advance();
+
+private:
+    void refill();
+
+    int fd_;
+    size_t read_;
+    size_t count_;
+    size_t bufferCount_;
+    size_t pos_;
+    Array<T> buffer_;
+};
+
+template<typename T>
+inline RunReader<T>::RunReader(const ExternalRun& run, size_t bufferCount)
+    : fd_(run.fd()), read_(0), count_(run.count()), bufferCount_(bufferCount), pos_(0) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    refill();
+}
+
+template<typename T>
+inline bool RunReader<T>::done() const {
+    return pos_ == buffer_.size();
+}
+
+template<typename T>
+inline const T& RunReader<T>::current() const {
+    return buffer_[pos_];
+}
+
+template<typename T>
+inline void RunReader<T>::advance() {
+    if (++pos_ == buffer_.size()) {
+        refill();
+    }
+}
+
+template<typename T>
+inline void RunReader<T>::refill() {
+    size_t n = std::min(bufferCount_, count_ - read_);
+    buffer_.clear();
+    pos_ = 0;
+    if (n == 0) return;
+    buffer_.resize_for_overwrite(n);
+    preadFully(fd_, buffer_.data(), sizeof(T) * n, off_t(sizeof(T) * read_));
+    read_ += n;
+}
+
+// Appends elements to a file through a buffer, keeping the count and the ArrayIO checksum of
+// everything written.
+template<typename T>
+class RunWriter final {
+public:
+    RunWriter(int fd, size_t bufferCount);
+
+    void push(const T& value);
+    void flush();
+
+    size_t count() const;
+    uint64_t checksum() const;
+
+private:
+    int fd_;
+    size_t count_;
+    size_t bufferCount_;
+    Array<T> buffer_;
+    ArrayChecksum checksum_;
+};
+
+template<typename T>
+inline RunWriter<T>::RunWriter(int fd, size_t bufferCount) : fd_(fd), count_(0), bufferCount_(bufferCount) {
+    buffer_.reserve(bufferCount);
+}
+
+template<typename T>
+inline void RunWriter<T>::push(const T& value) {
+    buffer_.push_back(value);
+    count_++;
+    if (buffer_.size() == bufferCount_) {
+        flush();
+    }
+}
+
+template<typename T>
+inline void RunWriter<T>::flush() {
+    checksum_.update(buffer_.data(), sizeof(T) * buffer_.size());
+    writeFully(fd_, buffer_.data(), sizeof(T) * buffer_.size());
+    buffer_.clear();
+}
+
+template<typename T>
+inline size_t RunWriter<T>::count() const {
+    return count_;
+}
+
+template<typename T>
+inline uint64_t RunWriter<T>::checksum() const {
+    return checksum_.value();
+}
+
+// Tournament tree over k runs that keeps the loser of every match in the inner nodes, so
+// replacing the winner replays only its path: log2(k) comparisons per element, against the
+// sibling losers only. tree_[0] is the overall winner, leaf i sits at k + i, exhausted runs
+// lose every match.
+template<typename T, typename Compare>
+class LoserTree final {
+public:
+    LoserTree(Array<RunReader<T>>& runs, Compare comp);
+
+    bool empty() const;
+    const T& top() const;
+    void pop();
+
+private:
+    bool beats(size_t a, size_t b) const;
+    size_t build(size_t node);
+
+    Array<RunReader<T>>& runs_;
+    Array<size_t> tree_;
+    Compare comp_;
+};
+
+template<typename T, typename Compare>
+inline LoserTree<T, Compare>::LoserTree(Array<RunReader<T>>& runs, Compare comp) : runs_(runs), comp_(comp) {
+    tree_.resize(runs.size());
+    tree_[0] = build(1);
+}
+
+template<typename T, typename Compare>
+inline bool LoserTree<T, Compare>::beats(size_t a, size_t b) const {
+    if (runs_[a].done()) return false;
+    return runs_[b].done() || comp_(runs_[a].current(), runs_[b].current());
+}
+
+template<typename T, typename Compare>
+inline size_t LoserTree<T, Compare>::build(size_t node) {
+    if (node >= runs_.size()) return node - runs_.size();
+    size_t left = build(2 * node);
+    size_t right = build(2 * node + 1);
+    if (beats(right, left)) {
+        tree_[node] = left;
+        return right;
+    }
+    tree_[node] = right;
+    return left;
+}
+
+template<typename T, typename Compare>
+inline bool LoserTree<T, Compare>::empty() const {
+    return runs_[tree_[0]].done();
+}
+
+template<typename T, typename Compare>
+inline const T& LoserTree<T, Compare>::top() const {
+    return runs_[tree_[0]].current();
+}
+
+template<typename T, typename Compare>
+inline void LoserTree<T, Compare>::pop() {
+    size_t winner = tree_[0];
+    runs_[winner].advance();
+    for (size_t node = (winner + runs_.size()) / 2; node > 0; node /= 2) {
+        if (beats(tree_[node], winner)) {
+            std::swap(tree_[node], winner);
+        }
+    }
+    tree_[0] = winner;
+}
+
+template<typename T, typename Compare>
+void mergeRuns(ExternalRun* runs, size_t k, RunWriter<T>& out, size_t bufferCount, Compare comp) {
+    Array<RunReader<T>> readers;
+    readers.reserve(k);
+    for (size_t i = 0; i < k; i++) {
+        readers.emplace_back(runs[i], bufferCount);
+    }
+
+    LoserTree<T, Compare> tree(readers, comp);
+    for (; !tree.empty(); tree.pop()) {
+        out.push(tree.top());
+    }
+    out.flush();
+}
+
+// Calls write with a temp file next to path and renames it over path once write returns, so
+// path keeps its old contents when write throws.
+template<typename Write>
+void replaceFile(const std::string& path, Write write) {
+    std::string tempPath = path + ".XXXXXX";
+    int fd = ::mkstemp(tempPath.data());
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "ExternalSort: cannot create a file next to " + path);
+    }
+    try {
+        if (::fchmod(fd, 0644) != 0) {
+            throw std::system_error(errno, std::generic_category(), "ExternalSort: cannot set the mode of " + tempPath);
+        }
+        write(fd);
+        if (::close(fd) != 0) {
+            fd = -1;
+            throw std::system_error(errno, std::generic_category(), "ExternalSort: cannot write " + tempPath);
+        }
+        fd = -1;
+        if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+            throw std::system_error(errno, std::generic_category(), "ExternalSort: cannot replace " + path);
+        }
+    } catch (...) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+}
+
+// Sorts the array file inputPath into the array file outputPath, which may be the same file.
+// The output is written to a temp file in the directory of outputPath that replaces it only
+// when the sort is complete, so a sort that fails midway leaves outputPath, and with it an
+// input sorted in place, as it was. T must be trivially copyable.
+template<typename T, typename Compare = std::less<T>>
+void externalSort(const std::string& inputPath, const std::string& outputPath, Compare comp = Compare(),
+                  const ExternalSortOptions& options = ExternalSortOptions()) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be sorted on disk");
+
+    std::string dir = options.tempDir.empty() ? std::filesystem::temp_directory_path().string() : options.tempDir;
+    size_t budget = std::max(options.memoryBudget / sizeof(T), size_t(6));
+
+    auto sortChunk = [&](Array<T>& chunk) {
+        if (options.pool) {
+            ssort(*options.pool, chunk.begin(), chunk.end(), comp);
+        } else {
+            ssort(chunk.begin(), chunk.end(), comp);
+        }
+    };
+
+    // run formation: a third of the budget per chunk leaves room for the next chunk and for
+    // the scratch of a radix sort
+    size_t chunkCount = budget / 3;
+    ArrayReader<T> reader(inputPath);
+    Array<T> chunk, next;
+    reader.read(chunk, chunkCount);
+
+    if (reader.remaining() == 0) {
+        sortChunk(chunk);
+        replaceFile(outputPath, [&](int fd) { writeArray(fd, chunk); });
+        return;
+    }
+
+    Array<ExternalRun> runs;
+    while (chunk.size() != 0) {
+        std::exception_ptr readError;
+        std::thread prefetch([&] {
+            try {
+                reader.read(next, chunkCount);
+            } catch (...) {
+                readError = std::current_exception();
+            }
+        });
+
+        try {
+            sortChunk(chunk);
+            ExternalRun run(dir);
+            writeFully(run.fd(), chunk.data(), sizeof(T) * chunk.size());
+            run.setCount(chunk.size());
+            runs.push_back(std::move(run));
+        } catch (...) {
+            prefetch.join();
+            throw;
+        }
+        prefetch.join();
+        if (readError) std::rethrow_exception(readError);
+
+        std::swap(chunk, next);
+    }
+    chunk = Array<T>();
+    next = Array<T>();
+
+    // one buffer per run plus one for the output
+    size_t fanIn = std::max(budget * sizeof(T) / EXTERNAL_SORT_MIN_BUFFER, size_t(3)) - 1;
+    while (runs.size() > fanIn) {
+        Array<ExternalRun> merged;
+        for (size_t i = 0; i < runs.size(); i += fanIn) {
+            size_t k = std::min(fanIn, runs.size() - i);
+            if (k == 1) {
+                merged.push_back(std::move(runs[i]));
+                continue;
+            }
+            ExternalRun run(dir);
+            RunWriter<T> out(run.fd(), budget / (k + 1));
+            mergeRuns(&runs[i], k, out, budget / (k + 1), comp);
+            run.setCount(out.count());
+            merged.push_back(std::move(run));
+        }
+        runs = std::move(merged);
+    }
+
+    replaceFile(outputPath, [&](int fd) {
+        ArrayFileHeader header{};
+        writeFully(fd, &header, sizeof(header));
+
+        size_t bufferCount = budget / (runs.size() + 1);
+        RunWriter<T> out(fd, bufferCount);
+        mergeRuns(runs.data(), runs.size(), out, bufferCount, comp);
+
+        header.magic = arrayFileMagic;
+        header.version = arrayFileVersion;
+        header.byteOrder = arrayFileByteOrder;
+        header.elementSize = sizeof(T);
+        header.count = out.count();
+        header.checksum = out.checksum();
+        if (::pwrite(fd, &header, sizeof(header), 0) != ssize_t(sizeof(header))) {
+            throw std::system_error(errno, std::generic_category(), "ExternalSort: cannot write the header of " + outputPath);
+        }
+    });
+}
+
+#endif // EXTERNALSORT_H
@@ -1,14 +1,75 @@
+#ifndef INTROSORT_H
+#define INTROSORT_H
+
 #include <cmath>
 #include <iterator>
+#include <memory>
 #include <algorithm>
+#include <bit>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+#include "RadixSort.h"
+#include "SimdSort.h"
+#include "StringSort.h"
 
 #define SORT_THRESHOLD 16
+#define NINTHER_THRESHOLD 128
+// pdqsort gives up on partial insertion sort after moving elements this many places.
+#define PARTIAL_INSERTION_LIMIT 8
+// Elements the branchless partition classifies per block.
+#define PARTITION_BLOCK 64
+// stableSort extends shorter natural runs to this length with insertion sort.
+#define STABLE_MIN_RUN 32
+
+// What the heap functions call with every position they move an element to, for heaps that do
+// not track where their elements are.
+struct IgnorePlaced {
+    template<typename Index>
+    void operator()(Index) const {}
+};
+
+template<typename Iter, typename Compare>
+bool finishRun(Iter begin, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+void pdqsort(Iter begin, Iter end, Compare comp, int badAllowed, bool leftmost);
+
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> partitionRight(Iter begin, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> partitionRightBranchless(Iter begin, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+Iter partitionLeft(Iter begin, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+bool partialInsertionsort(Iter begin, Iter end, Compare comp);
 
 template<typename Iter, typename Compare>
 void introsort(Iter begin, Iter end, Compare comp, int maxdepth);
 
 template<typename Iter, typename Compare>
-Iter partition(Iter begin, Iter end, Compare comp);
+void stableSort(Iter begin, Iter end, Compare comp, std::iter_value_t<Iter>* buffer, size_t bufferSize);
+
+template<typename Iter, typename Compare>
+void mergeAdaptive(Iter first, Iter mid, Iter last, Compare comp, std::iter_value_t<Iter>* buffer, size_t bufferSize);
+
+template<typename Iter, typename Compare>
+void binaryInsertionsort(Iter begin, Iter sorted, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+Iter medianOf3(Iter a, Iter b, Iter c, Compare comp);
+
+template<typename Iter, typename Compare>
+void choosePivot(Iter begin, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+std::pair<Iter, Iter> partition(Iter begin, Iter end, Compare comp);
 
 template<typename Iter, typename Compare>
 void heapify(Iter begin, Iter end, Compare comp);
@@ -16,14 +77,294 @@ void heapify(Iter begin, Iter end, Compare comp);
 template<typename Iter, typename Compare>
 void heapsort(Iter begin, Iter end, Compare comp);
 
+template<typename Iter, typename Compare, typename Placed = IgnorePlaced>
+void siftDown(Iter begin, std::iter_difference_t<Iter> size, std::iter_difference_t<Iter> index, Compare comp,
+              Placed placed = Placed());
+
+template<typename Iter, typename Compare, typename Placed = IgnorePlaced>
+void siftUp(Iter begin, std::iter_difference_t<Iter> index, Compare comp, Placed placed = Placed());
+
+template<typename Iter, typename Compare, typename Placed = IgnorePlaced>
+std::iter_difference_t<Iter> siftToLeaf(Iter begin, std::iter_difference_t<Iter> size, std::iter_difference_t<Iter> index,
+                                        Compare comp, Placed placed = Placed());
+
 template<typename Iter, typename Compare>
 void insertionsort(Iter begin, Iter end, Compare comp);
 
 
 template<typename Iter, typename Compare>
 void ssort(Iter begin, Iter end, Compare comp) {
-    int maxdepth = std::floor(std::log(std::distance(begin, end)) / std::log(2)) * 2;
-    introsort(begin, end, comp, maxdepth);
+    if (finishRun(begin, end, comp)) return;
+
+    if constexpr (RadixSortable<Iter, Compare>) {
+        bool simd = SimdSortable<Iter, Compare> && simdLevel() != SimdLevel::Scalar;
+        if (radixSortFaster<std::iter_value_t<Iter>>(std::distance(begin, end), simd)) {
+            radixSort(begin, end, radixKeyFor<std::iter_value_t<Iter>>(comp));
+            return;
+        }
+    }
+    if constexpr (SimdSortable<Iter, Compare>) {
+        if (simdSort(std::to_address(begin), std::to_address(end))) return;
+    }
+    if constexpr (StringSortable<Iter, Compare>) {
+        if (std::distance(begin, end) >= STRING_SORT_THRESHOLD) {
+            stringSort(begin, end, comp);
+            return;
+        }
+    }
+    pdqsort(begin, end, comp, std::bit_width(size_t(std::distance(begin, end))), true);
+}
+
+// Sorts a range that is one run: already in order (nothing to do) or strictly descending
+// (reversed). Returns false at the first element that breaks both, so other ranges only pay for
+// their first few comparisons.
+template<typename Iter, typename Compare>
+bool finishRun(Iter begin, Iter end, Compare comp) {
+    if (std::distance(begin, end) < 2) return true;
+
+    Iter next = begin + 1;
+    if (!comp(*next, *begin)) {
+        return std::is_sorted_until(next, end, comp) == end;
+    }
+    while (++next != end && comp(*next, *(next - 1))) {}
+    if (next != end) return false;
+    std::reverse(begin, end);
+    return true;
+}
+
+// Pattern-defeating quicksort (Orson Peters' pdqsort) in introsort's place:
+// - a partition that swapped nothing hints at sorted input, so both sides get an insertion sort
+//   that gives up after PARTIAL_INSERTION_LIMIT moves and finishes runs in linear time;
+// - a partition worse than 1:7 swaps a few elements at fixed offsets to break the pattern that
+//   caused it, and after log2(n) of those the range goes to heapsort;
+// - a range whose pivot equals the element before it (the pivot of an enclosing partition)
+//   holds many copies of that key: partitionLeft() splits them off and they are not recursed into;
+// - arithmetic elements are partitioned branch-free in blocks.
+// leftmost says whether [begin, end) is the leftmost part of the whole range, i.e. whether
+// begin - 1 may be read.
+template<typename Iter, typename Compare>
+void pdqsort(Iter begin, Iter end, Compare comp, int badAllowed, bool leftmost) {
+    for (;;) {
+        auto n = std::distance(begin, end);
+        if (n < SORT_THRESHOLD) {
+            insertionsort(begin, end, comp);
+            return;
+        }
+
+        choosePivot(begin, end, comp);
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = partitionLeft(begin, end, comp) + 1;
+            continue;
+        }
+
+        std::pair<Iter, bool> split;
+        if constexpr (std::is_arithmetic_v<std::iter_value_t<Iter>>) {
+            split = partitionRightBranchless(begin, end, comp);
+        } else {
+            split = partitionRight(begin, end, comp);
+        }
+        auto [pivot, alreadyPartitioned] = split;
+        auto leftSize = std::distance(begin, pivot);
+        auto rightSize = std::distance(pivot + 1, end);
+
+        if (leftSize < n / 8 || rightSize < n / 8) {
+            if (--badAllowed == 0) {
+                heapsort(begin, end, comp);
+                return;
+            }
+            if (leftSize >= SORT_THRESHOLD) {
+                std::iter_swap(begin, begin + leftSize / 4);
+                std::iter_swap(pivot - 1, pivot - leftSize / 4);
+                if (leftSize > NINTHER_THRESHOLD) {
+                    std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+                    std::iter_swap(pivot - 2, pivot - (leftSize / 4 + 1));
+                    std::iter_swap(pivot - 3, pivot - (leftSize / 4 + 2));
+                }
+            }
+            if (rightSize >= SORT_THRESHOLD) {
+                std::iter_swap(pivot + 1, pivot + (1 + rightSize / 4));
+                std::iter_swap(end - 1, end - rightSize / 4);
+                if (rightSize > NINTHER_THRESHOLD) {
+                    std::iter_swap(pivot + 2, pivot + (2 + rightSize / 4));
+                    std::iter_swap(pivot + 3, pivot + (3 + rightSize / 4));
+                    std::iter_swap(end - 2, end - (1 + rightSize / 4));
+                    std::iter_swap(end - 3, end - (2 + rightSize / 4));
+                }
+            }
+        }
+        else if (alreadyPartitioned && partialInsertionsort(begin, pivot, comp)
+                 && partialInsertionsort(pivot + 1, end, comp)) {
+            return;
+        }
+
+        pdqsort(begin, pivot, comp, badAllowed, leftmost);
+        begin = pivot + 1;
+        leftmost = false;
+    }
+}
+
+// Partitions around *begin into [begin, pivot) below it and (pivot, end) not below it and
+// moves the pivot to pivot. Needs an element not below *begin after it, which choosePivot()
+// leaves there. The flag tells whether no element had to be swapped.
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> partitionRight(Iter begin, Iter end, Compare comp) {
+    Iter first = begin, last = end;
+
+    while (comp(*++first, *begin)) {}
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, *begin)) {}
+    } else {
+        while (!comp(*--last, *begin)) {}
+    }
+
+    bool alreadyPartitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*++first, *begin)) {}
+        while (!comp(*--last, *begin)) {}
+    }
+
+    Iter pivot = first - 1;
+    std::iter_swap(begin, pivot);
+    return { pivot, alreadyPartitioned };
+}
+
+// partitionRight() for cheap comparisons (BlockQuicksort, Edelkamp and Weiss). Each side
+// records in a block of offsets which of its next PARTITION_BLOCK elements are misplaced,
+// adding the comparison result to a counter instead of branching on it, and the recorded
+// pairs are then swapped with one cyclic move.
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> partitionRightBranchless(Iter begin, Iter end, Compare comp) {
+    std::iter_value_t<Iter> pivotValue = *begin;
+    Iter first = begin, last = end;
+
+    while (comp(*++first, pivotValue)) {}
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivotValue)) {}
+    } else {
+        while (!comp(*--last, pivotValue)) {}
+    }
+
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+        std::iter_swap(first, last);
+        ++first;
+
+        unsigned char leftOffsets[PARTITION_BLOCK], rightOffsets[PARTITION_BLOCK];
+        Iter leftBase = first, rightBase = last;
+        size_t leftCount = 0, rightCount = 0, leftStart = 0, rightStart = 0;
+
+        while (first < last) {
+            // refill the empty blocks, splitting the unknown elements between them
+            size_t unknown = last - first;
+            size_t leftSplit = leftCount == 0 ? (rightCount == 0 ? unknown / 2 : unknown) : 0;
+            size_t rightSplit = rightCount == 0 ? unknown - leftSplit : 0;
+
+            for (size_t i = 0, count = std::min<size_t>(leftSplit, PARTITION_BLOCK); i < count; i++) {
+                leftOffsets[leftCount] = i;
+                leftCount += !comp(*first, pivotValue);
+                ++first;
+            }
+            for (size_t i = 0, count = std::min<size_t>(rightSplit, PARTITION_BLOCK); i < count; ) {
+                rightOffsets[rightCount] = ++i;
+                rightCount += comp(*--last, pivotValue);
+            }
+
+            size_t count = std::min(leftCount, rightCount);
+            Iter left = leftBase, right = rightBase;
+            unsigned char* lo = leftOffsets + leftStart;
+            unsigned char* ro = rightOffsets + rightStart;
+            if (leftCount == rightCount) {
+                // plain swaps keep descending input linear
+                for (size_t i = 0; i < count; i++) {
+                    std::iter_swap(left + lo[i], right - ro[i]);
+                }
+            } else if (count > 0) {
+                std::iter_value_t<Iter> tmp = std::move(left[lo[0]]);
+                left[lo[0]] = std::move(*(right - ro[0]));
+                for (size_t i = 1; i < count; i++) {
+                    *(right - ro[i - 1]) = std::move(left[lo[i]]);
+                    left[lo[i]] = std::move(*(right - ro[i]));
+                }
+                *(right - ro[count - 1]) = std::move(tmp);
+            }
+            leftCount -= count;
+            rightCount -= count;
+            leftStart += count;
+            rightStart += count;
+
+            if (leftCount == 0) {
+                leftStart = 0;
+                leftBase = first;
+            }
+            if (rightCount == 0) {
+                rightStart = 0;
+                rightBase = last;
+            }
+        }
+
+        // one block still has misplaced elements, move them to the boundary
+        if (leftCount) {
+            while (leftCount--) std::iter_swap(leftBase + leftOffsets[leftStart + leftCount], --last);
+            first = last;
+        }
+        if (rightCount) {
+            while (rightCount--) std::iter_swap(rightBase - rightOffsets[rightStart + rightCount], first++);
+            last = first;
+        }
+    }
+
+    Iter pivot = first - 1;
+    std::iter_swap(begin, pivot);
+    return { pivot, alreadyPartitioned };
+}
+
+// Partitions around *begin into [begin, pivot] not above it and (pivot, end) above it, for a
+// range where nothing is below *begin: everything left of pivot equals it.
+template<typename Iter, typename Compare>
+Iter partitionLeft(Iter begin, Iter end, Compare comp) {
+    Iter first = begin, last = end;
+
+    while (comp(*begin, *--last)) {}
+    if (last + 1 == end) {
+        while (first < last && !comp(*begin, *++first)) {}
+    } else {
+        while (!comp(*begin, *++first)) {}
+    }
+
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*begin, *--last)) {}
+        while (!comp(*begin, *++first)) {}
+    }
+
+    std::iter_swap(begin, last);
+    return last;
+}
+
+// Insertion sort that stops and returns false once it has moved elements more than
+// PARTIAL_INSERTION_LIMIT places in total.
+template<typename Iter, typename Compare>
+bool partialInsertionsort(Iter begin, Iter end, Compare comp) {
+    if (begin == end) return true;
+
+    std::iter_difference_t<Iter> moved = 0;
+    for (Iter i = begin + 1; i != end; ++i) {
+        if (!comp(*i, *(i - 1))) continue;
+
+        std::iter_value_t<Iter> value = std::move(*i);
+        Iter j = i;
+        do {
+            *j = std::move(*(j - 1));
+            --j;
+        } while (j != begin && comp(value, *(j - 1)));
+        *j = std::move(value);
+
+        moved += i - j;
+        if (moved > PARTIAL_INSERTION_LIMIT) return false;
+    }
+    return true;
 }
 
 template<typename Iter, typename Compare>
@@ -35,61 +376,157 @@ void introsort(Iter begin, Iter end, Compare comp, int maxdepth) {
         heapsort(begin, end, comp);
     }
     else {
-        Iter pivot = ::partition(begin, end, comp);
-        introsort(begin, pivot, comp, maxdepth - 1);
-        introsort(pivot, end, comp, maxdepth - 1);
+        choosePivot(begin, end, comp);
+        auto [lower, upper] = ::partition(begin, end, comp);
+        introsort(begin, lower, comp, maxdepth - 1);
+        introsort(upper, end, comp, maxdepth - 1);
     }
 }
 
 template<typename Iter, typename Compare>
-Iter partition(Iter begin, Iter end, Compare comp) {
-    const auto& pivot = end[-1];
-    Iter i = begin;
-    for (Iter j = begin; j < end - 1; ++j) {
-        if (!comp(pivot, *j)) {
-            if (j != i) std::iter_swap(i, j);
-            i++;
-        }
+Iter medianOf3(Iter a, Iter b, Iter c, Compare comp) {
+    if (comp(*a, *b)) {
+        if (comp(*b, *c)) return b;
+        return comp(*a, *c) ? c : a;
     }
-    std::iter_swap(i, end - 1);
-    return i + 1;
+    if (comp(*a, *c)) return a;
+    return comp(*b, *c) ? c : b;
 }
 
+// Moves the pivot to begin: the median of the first, middle and last element, or for large
+// ranges Tukey's ninther (the median of three such medians), so sorted, reversed and
+// organ-pipe inputs still split near the middle.
 template<typename Iter, typename Compare>
-void heapify(Iter begin, Iter end, Compare comp) {
+void choosePivot(Iter begin, Iter end, Compare comp) {
     auto n = std::distance(begin, end);
+    Iter mid = begin + n / 2;
+    Iter last = end - 1;
+    Iter pivot;
+
+    if (n > NINTHER_THRESHOLD) {
+        auto step = n / 8;
+        pivot = medianOf3(medianOf3(begin, begin + step, begin + 2 * step, comp),
+                          medianOf3(mid - step, mid, mid + step, comp),
+                          medianOf3(last - 2 * step, last - step, last, comp), comp);
+    } else {
+        pivot = medianOf3(begin, mid, last, comp);
+    }
+    std::iter_swap(begin, pivot);
+}
 
-    for (typename Iter::difference_type i = 1; i < n; ++i) {
-        if (comp(begin[(i - 1) / 2], begin[i])) {
-            auto j = i;
+// Three-way partition around *begin (Bentley-McIlroy). Scans from both ends like Hoare's
+// scheme and parks keys equal to the pivot at the ends, then swaps them into the middle.
+// Returns [lower, upper), the run of keys equal to the pivot, which needs no further sorting;
+// with few distinct keys most of the range ends up there.
+template<typename Iter, typename Compare>
+std::pair<Iter, Iter> partition(Iter begin, Iter end, Compare comp) {
+    // [begin, a) equal, [a, b) less, (c, d] greater, (d, end) equal
+    Iter a = begin + 1, b = begin + 1;
+    Iter c = end - 1, d = end - 1;
 
-            while (comp(begin[(j - 1) / 2], begin[j])) {
-                std::iter_swap(begin + j, begin + (j - 1) / 2);
-                j = (j - 1) / 2;
+    for (;;) {
+        while (b <= c && !comp(*begin, *b)) {
+            if (!comp(*b, *begin)) {
+                std::iter_swap(a, b);
+                ++a;
             }
+            ++b;
         }
+        while (b <= c && !comp(*c, *begin)) {
+            if (!comp(*begin, *c)) {
+                std::iter_swap(c, d);
+                --d;
+            }
+            --c;
+        }
+        if (b > c) break;
+        std::iter_swap(b, c);
+        ++b;
+        --c;
+    }
+
+    auto left = std::min(a - begin, b - a);
+    std::swap_ranges(begin, begin + left, b - left);
+    auto right = std::min(d - c, end - 1 - d);
+    std::swap_ranges(b, b + right, end - right);
+
+    return { begin + (b - a), end - (d - c) };
+}
+
+// Floyd's bottom-up construction: sifting down every inner node, last first, costs O(n) since
+// most nodes sit near the leaves and only sift a level or two.
+template<typename Iter, typename Compare>
+void heapify(Iter begin, Iter end, Compare comp) {
+    auto n = std::distance(begin, end);
+
+    for (auto i = n / 2; i > 0; --i) {
+        siftDown(begin, n, i - 1, comp);
     }
 }
 
+// The element swapped to the root from the end of the heap is one of the smallest, so instead
+// of comparing it against both children on every level the hole the root leaves is walked down
+// to a leaf along the larger children (Floyd's bounce), one comparison per level, and the
+// element is sifted up from there, rarely more than a level.
 template<typename Iter, typename Compare>
 void heapsort(Iter begin, Iter end, Compare comp) {
     heapify(begin, end, comp);
 
-    for (auto i = std::distance(begin, end - 1); i > 0; --i) {
-        std::iter_swap(begin, begin + i);
-        typename Iter::difference_type j = 0, index;
-
-        do {
-            index = (2 * j + 1);
+    for (auto i = std::distance(begin, end) - 1; i > 0; --i) {
+        std::iter_value_t<Iter> value = std::move(begin[i]);
+        begin[i] = std::move(begin[0]);
+        auto leaf = siftToLeaf(begin, i, 0, comp);
+        begin[leaf] = std::move(value);
+        siftUp(begin, leaf, comp);
+    }
+}
 
-            if (index < (i - 1) && comp(begin[index], begin[index + 1]))
-                index++;
+// Moves begin[index] down the max-heap [begin, begin + size) until neither child is above it.
+// Children move up into the hole instead of being swapped with it, one move per level.
+template<typename Iter, typename Compare, typename Placed>
+void siftDown(Iter begin, std::iter_difference_t<Iter> size, std::iter_difference_t<Iter> index, Compare comp,
+              Placed placed) {
+    std::iter_value_t<Iter> value = std::move(begin[index]);
+    for (;;) {
+        auto child = 2 * index + 1;
+        if (child >= size) break;
+        if (child + 1 < size && comp(begin[child], begin[child + 1])) child++;
+        if (!comp(value, begin[child])) break;
+        begin[index] = std::move(begin[child]);
+        placed(index);
+        index = child;
+    }
+    begin[index] = std::move(value);
+    placed(index);
+}
 
-            if (index < i && comp(begin[j], begin[index]))
-                std::iter_swap(begin + j, begin + index);
+// Moves begin[index] up the max-heap while its parent is below it.
+template<typename Iter, typename Compare, typename Placed>
+void siftUp(Iter begin, std::iter_difference_t<Iter> index, Compare comp, Placed placed) {
+    std::iter_value_t<Iter> value = std::move(begin[index]);
+    while (index > 0) {
+        auto parent = (index - 1) / 2;
+        if (!comp(begin[parent], value)) break;
+        begin[index] = std::move(begin[parent]);
+        placed(index);
+        index = parent;
+    }
+    begin[index] = std::move(value);
+    placed(index);
+}
 
-            j = index;
-        } while (index < i);
+// Treats begin[index] as empty and fills it from the larger child, down to a leaf, whose now
+// empty position is returned.
+template<typename Iter, typename Compare, typename Placed>
+std::iter_difference_t<Iter> siftToLeaf(Iter begin, std::iter_difference_t<Iter> size, std::iter_difference_t<Iter> index,
+                                        Compare comp, Placed placed) {
+    for (;;) {
+        auto child = 2 * index + 1;
+        if (child >= size) return index;
+        if (child + 1 < size && comp(begin[child], begin[child + 1])) child++;
+        begin[index] = std::move(begin[child]);
+        placed(index);
+        index = child;
     }
 }
 
@@ -101,3 +538,314 @@ void insertionsort(Iter begin, Iter end, Compare comp) {
         }
     }
 }
+
+// Stable adaptive merge sort. The range is cut into natural runs, ascending or strictly
+// descending (reversed in place), and runs shorter than STABLE_MIN_RUN are extended by binary
+// insertion sort; each run is merged with the one before it as soon as both span as many
+// natural runs, like carries of a binary counter, and the rest at the end. Sorted input costs one
+// scan. Merges move the shorter run into the buffer when it fits and otherwise split
+// themselves by rotation until the pieces do, so any buffer size works, none at all included.
+// This overload allocates a buffer of half the range and merges in place if that fails. The
+// buffer is raw memory whose elements are move constructed from the front of the range and
+// moved back, so it holds valid elements to assign to without T being default constructible.
+template<typename Iter, typename Compare>
+void stableSort(Iter begin, Iter end, Compare comp) {
+    using T = std::iter_value_t<Iter>;
+    size_t bufferSize = (std::distance(begin, end) + 1) / 2;
+    T* buffer = (T*)::operator new(bufferSize * sizeof(T), std::nothrow);
+    if (buffer == nullptr) {
+        stableSort(begin, end, comp, buffer, 0);
+        return;
+    }
+
+    try {
+        std::uninitialized_move(begin, begin + bufferSize, buffer);
+    } catch (...) {
+        ::operator delete(buffer);
+        throw;
+    }
+    std::move(buffer, buffer + bufferSize, begin);
+    try {
+        stableSort(begin, end, comp, buffer, bufferSize);
+    } catch (...) {
+        std::destroy(buffer, buffer + bufferSize);
+        ::operator delete(buffer);
+        throw;
+    }
+    std::destroy(buffer, buffer + bufferSize);
+    ::operator delete(buffer);
+}
+
+// Uses the elements of buffer as scratch space and never allocates; an empty buffer sorts
+// entirely in place, one of half the range never rotates.
+template<typename Iter, typename Compare>
+void stableSort(Iter begin, Iter end, Compare comp, Array<std::iter_value_t<Iter>>& buffer) {
+    stableSort(begin, end, comp, buffer.data(), buffer.size());
+}
+
+template<typename Iter, typename Compare>
+void stableSort(Iter begin, Iter end, Compare comp, std::iter_value_t<Iter>* buffer, size_t bufferSize) {
+    auto n = std::distance(begin, end);
+    if (n < 2) return;
+
+    // pending runs, each spanning 2^level natural runs; levels fall towards the top, so there
+    // is at most one run per bit of the run count and every element takes part in log2(runs)
+    // merges
+    struct PendingRun {
+        std::iter_difference_t<Iter> start;
+        int level;
+    };
+    PendingRun stack[64];
+    int depth = 0;
+
+    for (Iter run = begin; run != end; ) {
+        Iter next = run + 1;
+        if (next != end && comp(*next, *run)) {
+            while (next != end && comp(*next, *(next - 1))) ++next;
+            std::reverse(run, next);
+        } else {
+            while (next != end && !comp(*next, *(next - 1))) ++next;
+        }
+        if (next - run < STABLE_MIN_RUN) {
+            Iter extended = end - next < STABLE_MIN_RUN - (next - run) ? end : run + STABLE_MIN_RUN;
+            binaryInsertionsort(run, next, extended, comp);
+            next = extended;
+        }
+
+        int level = 0;
+        while (depth > 0 && stack[depth - 1].level == level) {
+            Iter below = begin + stack[--depth].start;
+            mergeAdaptive(below, run, next, comp, buffer, bufferSize);
+            run = below;
+            level++;
+        }
+        stack[depth++] = { run - begin, level };
+        run = next;
+    }
+
+    for (; depth > 1; depth--) {
+        mergeAdaptive(begin + stack[depth - 2].start, begin + stack[depth - 1].start, end, comp, buffer, bufferSize);
+    }
+}
+
+// Merges the sorted runs [first, mid) and [mid, last), keeping equal elements in order.
+template<typename Iter, typename Compare>
+void mergeAdaptive(Iter first, Iter mid, Iter last, Compare comp, std::iter_value_t<Iter>* buffer, size_t bufferSize) {
+    if (first == mid || mid == last || !comp(*mid, *(mid - 1))) return;
+
+    // the head of the left run and the tail of the right run are already in place
+    first = std::upper_bound(first, mid, *mid, comp);
+    last = std::lower_bound(mid, last, *(mid - 1), comp);
+    size_t leftSize = mid - first, rightSize = last - mid;
+
+    if (leftSize == 1 && rightSize == 1) {
+        std::iter_swap(first, mid);
+    }
+    else if (leftSize <= rightSize && leftSize <= bufferSize) {
+        auto bufferEnd = std::move(first, mid, buffer);
+        for (auto b = buffer; b != bufferEnd; ) {
+            if (mid == last) {
+                std::move(b, bufferEnd, first);
+                break;
+            }
+            *first++ = comp(*mid, *b) ? std::move(*mid++) : std::move(*b++);
+        }
+    }
+    else if (rightSize <= bufferSize) {
+        auto bufferEnd = std::move(mid, last, buffer);
+        for (auto b = bufferEnd; b != buffer; ) {
+            if (mid == first) {
+                std::move_backward(buffer, b, last);
+                break;
+            }
+            *--last = comp(*(b - 1), *(mid - 1)) ? std::move(*--mid) : std::move(*--b);
+        }
+    }
+    else {
+        // cut the longer run in half and the other where the half's first element belongs,
+        // swap the middle pieces by rotation and merge both sides
+        Iter leftCut, rightCut;
+        if (leftSize > rightSize) {
+            leftCut = first + leftSize / 2;
+            rightCut = std::lower_bound(mid, last, *leftCut, comp);
+        } else {
+            rightCut = mid + rightSize / 2;
+            leftCut = std::upper_bound(first, mid, *rightCut, comp);
+        }
+        Iter newMid = std::rotate(leftCut, mid, rightCut);
+        mergeAdaptive(first, leftCut, newMid, comp, buffer, bufferSize);
+        mergeAdaptive(newMid, rightCut, last, comp, buffer, bufferSize);
+    }
+}
+
+// Extends the sorted run [begin, sorted) to [begin, end), inserting each element after the
+// equal ones already in place.
+template<typename Iter, typename Compare>
+void binaryInsertionsort(Iter begin, Iter sorted, Iter end, Compare comp) {
+    for (; sorted != end; ++sorted) {
+        Iter position = std::upper_bound(begin, sorted, *sorted, comp);
+        if (position != sorted) {
+            std::iter_value_t<Iter> value = std::move(*sorted);
+            std::move_backward(position, sorted, sorted + 1);
+            *position = std::move(value);
+        }
+    }
+}
+
+// Key each element of [begin, end) is ordered by, and the (key, position) pairs the
+// projection sorts are built from.
+template<typename Iter, typename Proj>
+using ProjectedKey = std::remove_cvref_t<std::invoke_result_t<Proj&, std::iter_reference_t<Iter>>>;
+
+template<typename Iter, typename Proj>
+Array<std::pair<ProjectedKey<Iter, Proj>, size_t>> projectKeys(Iter begin, Iter end, Proj& proj) {
+    Array<std::pair<ProjectedKey<Iter, Proj>, size_t>> keys;
+    keys.reserve(std::distance(begin, end));
+    size_t i = 0;
+    for (Iter it = begin; it != end; ++it) {
+        keys.emplace_back(std::invoke(proj, *it), i++);
+    }
+    return keys;
+}
+
+// Moves each element of [begin, end) to the position its key ended up at, following the cycles
+// of the permutation so every element is moved once. Consumes the positions in keys.
+template<typename Iter, typename Key>
+void applyKeyOrder(Iter begin, Array<std::pair<Key, size_t>>& keys) {
+    for (size_t start = 0; start < keys.size(); start++) {
+        if (keys[start].second == start) continue;
+
+        std::iter_value_t<Iter> value = std::move(begin[start]);
+        size_t i = start;
+        while (keys[i].second != start) {
+            size_t from = keys[i].second;
+            begin[i] = std::move(begin[from]);
+            keys[i].second = i;
+            i = from;
+        }
+        begin[i] = std::move(value);
+        keys[i].second = i;
+    }
+}
+
+// Sorts keys from projectKeys() by comp and hands done an Array of (key, position) pairs in
+// order: keys itself, or (view, position) pairs when the keys are strings.
+template<typename Key, typename Compare, typename Done>
+void sortProjectedKeys(Array<std::pair<Key, size_t>>& keys, Compare comp, Done done) {
+    if constexpr (RadixSortable<Key*, Compare>) {
+        if (radixSortFaster<Key>(keys.size(), false)) {
+            auto radixKey = radixKeyFor<Key>(comp);
+            radixSort(keys.begin(), keys.end(), [&](const std::pair<Key, size_t>& k) { return radixKey(k.first); });
+            done(keys);
+            return;
+        }
+    }
+    if constexpr (StringSortable<Key*, Compare>) {
+        if (keys.size() >= STRING_SORT_THRESHOLD) {
+            Array<StringRef> refs;
+            refs.reserve(keys.size());
+            for (const auto& key : keys) {
+                refs.emplace_back(std::string_view(key.first), key.second);
+            }
+            sortStringRefs(refs, stringSortDescending<Compare>());
+            done(refs);
+            return;
+        }
+    }
+    ssort(keys.begin(), keys.end(), [&](const std::pair<Key, size_t>& a, const std::pair<Key, size_t>& b) {
+        return comp(a.first, b.first);
+    });
+    done(keys);
+}
+
+// ssort by proj(element): every key is computed once, the (key, position) pairs are sorted,
+// radix sorted when the key is arithmetic and comp std::less or std::greater, and then every
+// element is moved once to its place. Worth it when proj is costly or the elements are large.
+template<std::random_access_iterator Iter, typename Compare, typename Proj>
+void ssort(Iter begin, Iter end, Compare comp, Proj proj) {
+    auto keys = projectKeys(begin, end, proj);
+    sortProjectedKeys(keys, comp, [&](auto& sorted) { applyKeyOrder(begin, sorted); });
+}
+
+// Indirect sort: returns the positions of the elements of [begin, end) in sorted order, so
+// begin[order[0]] comes first, without moving any element. The positions are sorted by comp
+// on the elements they point to.
+template<std::random_access_iterator Iter, typename Compare>
+Array<size_t> argsort(Iter begin, Iter end, Compare comp) {
+    Array<size_t> order;
+    order.reserve(std::distance(begin, end));
+    for (size_t i = 0; i < size_t(std::distance(begin, end)); i++) {
+        order.push_back(i);
+    }
+    ssort(order.begin(), order.end(), [&](size_t a, size_t b) { return comp(begin[a], begin[b]); });
+    return order;
+}
+
+// argsort by proj(element). The keys are packed next to the positions, so sorting never goes
+// back to the elements, and are radix or string sorted as for ssort by proj.
+template<std::random_access_iterator Iter, typename Compare, typename Proj>
+Array<size_t> argsort(Iter begin, Iter end, Compare comp, Proj proj) {
+    auto keys = projectKeys(begin, end, proj);
+    Array<size_t> order;
+    order.reserve(keys.size());
+    sortProjectedKeys(keys, comp, [&](auto& sorted) {
+        for (const auto& key : sorted) {
+            order.push_back(key.second);
+        }
+    });
+    return order;
+}
+
+template<std::random_access_iterator Iter>
+void applyPermutationTo(Array<size_t>& order, Iter begin) {
+    constexpr size_t done = ~(~size_t(0) >> 1);
+
+    for (size_t start = 0; start < order.size(); start++) {
+        if ((order[start] & done) || order[start] == start) continue;
+
+        std::iter_value_t<Iter> value = std::move(begin[start]);
+        size_t i = start;
+        while (order[i] != start) {
+            size_t from = order[i];
+            begin[i] = std::move(begin[from]);
+            order[i] |= done;
+            i = from;
+        }
+        begin[i] = std::move(value);
+        order[i] |= done;
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] &= ~done;
+    }
+}
+
+// Reorders the range at every begin so that its element i is the one that was at order[i], as
+// argsort() returns it, following the cycles of order so every element is moved once.
+// Positions done are marked in the top bit of order and unmarked at the end, so one order
+// reorders several parallel ranges: applyPermutation(order, keys.begin(), values.begin()).
+template<std::random_access_iterator... Iters>
+void applyPermutation(Array<size_t>& order, Iters... begins) {
+    (applyPermutationTo(order, begins), ...);
+}
+
+// stableSort by proj(element), keys computed once as for ssort.
+template<std::random_access_iterator Iter, typename Compare, typename Proj>
+void stableSort(Iter begin, Iter end, Compare comp, Proj proj) {
+    using Key = ProjectedKey<Iter, Proj>;
+    auto keys = projectKeys(begin, end, proj);
+
+    if constexpr (RadixSortable<Key*, Compare>) {
+        if (radixSortFaster<Key>(keys.size(), false)) {
+            auto radixKey = radixKeyFor<Key>(comp);
+            radixSort(keys.begin(), keys.end(), [&](const std::pair<Key, size_t>& k) { return radixKey(k.first); });
+            applyKeyOrder(begin, keys);
+            return;
+        }
+    }
+    stableSort(keys.begin(), keys.end(), [&](const std::pair<Key, size_t>& a, const std::pair<Key, size_t>& b) {
+        return comp(a.first, b.first);
+    });
+    applyKeyOrder(begin, keys);
+}
+
+#endif // INTROSORT_H
@@ -0,0 +1,359 @@
+#ifndef MAPPEDARRAY_H
+#define MAPPEDARRAY_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Array.h"
+
+// Array-like container whose elements live in a memory-mapped file. Opening an existing file
+// maps it without reading it, pages are loaded on first access and every change is written
+// back by the kernel (flush() forces it). The element count is kept in the file header, so a
+// reopened array continues where the previous one stopped. ReadOnly maps the file shared and
+// read-only, which lets several processes use the same pages; reading goes through the const
+// accessors and cbegin()/cend(), while anything that hands out a mutable element or pointer
+// throws std::logic_error, as writing to the mapping would fault.
+template<typename T, typename Growth = DoublingGrowth>
+class MappedArray final {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedArray stores raw bytes, T must be trivially copyable");
+
+public:
+    using size_type = size_t;
+    using Iterator = T*;
+    using ConstIterator = const T*;
+
+    enum class Mode { ReadWrite, ReadOnly };
+
+    MappedArray(const std::string& path, Mode mode = Mode::ReadWrite);
+    MappedArray(const MappedArray& other) = delete;
+    MappedArray(MappedArray&& other);
+    ~MappedArray();
+
+    void reserve(size_type newCapacity);
+    size_type push_back(const T& value);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+    template<std::input_iterator InputIt>
+    void append(InputIt first, InputIt last);
+    void resize(size_type newSize);
+    void clear();
+
+    void flush(bool async = false);
+
+    const T& operator[](size_type index) const;
+    T& operator[](size_type index);
+
+    MappedArray& operator=(const MappedArray& other) = delete;
+    MappedArray& operator=(MappedArray&& other);
+
+    size_type size() const;
+    size_type capacity() const;
+    bool readOnly() const;
+
+    T* data();
+    const T* data() const;
+
+    Iterator begin();
+    ConstIterator cbegin() const;
+    Iterator end();
+    ConstIterator cend() const;
+
+private:
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t elementSize;
+        uint64_t size;
+        unsigned char reserved[40];
+    };
+
+    static constexpr uint64_t magic = 0x5941525241504d4dull; // "MMPARRAY"
+    static constexpr uint32_t version = 1;
+    static constexpr size_t headerSize = sizeof(Header);
+
+    static_assert(headerSize == 64 && alignof(T) <= headerSize, "elements must stay aligned after the header");
+
+    void map(size_t bytes);
+    void unmap();
+    void checkWritable() const;
+
+    int fd_;
+    Mode mode_;
+    char* base_;
+    size_t mappedBytes_;
+};
+
+template<typename T, typename Growth>
+inline MappedArray<T, Growth>::MappedArray(const std::string& path, Mode mode) : fd_(-1), mode_(mode), base_(nullptr), mappedBytes_(0) {
+    fd_ = ::open(path.c_str(), mode == Mode::ReadOnly ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "MappedArray: cannot open " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::generic_category(), "MappedArray: cannot stat " + path);
+    }
+
+    try {
+        if (st.st_size == 0) {
+            if (mode == Mode::ReadOnly) {
+                throw std::runtime_error("MappedArray: " + path + " is empty");
+            }
+            if (ftruncate(fd_, headerSize) != 0) {
+                throw std::system_error(errno, std::generic_category(), "MappedArray: cannot resize " + path);
+            }
+            map(headerSize);
+            Header* header = (Header*)base_;
+            header->magic = magic;
+            header->version = version;
+            header->elementSize = sizeof(T);
+            header->size = 0;
+        } else {
+            if ((size_t)st.st_size < headerSize) {
+                throw std::runtime_error("MappedArray: " + path + " is too small");
+            }
+            map(st.st_size);
+            const Header* header = (const Header*)base_;
+            if (header->magic != magic || header->version != version) {
+                throw std::runtime_error("MappedArray: " + path + " is not a MappedArray file");
+            }
+            if (header->elementSize != sizeof(T)) {
+                throw std::runtime_error("MappedArray: " + path + " holds elements of a different size");
+            }
+            if (header->size > capacity()) {
+                throw std::runtime_error("MappedArray: " + path + " is truncated");
+            }
+        }
+    } catch (...) {
+        unmap();
+        ::close(fd_);
+        throw;
+    }
+}
+
+template<typename T, typename Growth>
+inline MappedArray<T, Growth>::MappedArray(MappedArray&& other) : fd_(-1), mode_(other.mode_), base_(nullptr), mappedBytes_(0) {
+    *this = std::move(other);
+}
+
+template<typename T, typename Growth>
+inline MappedArray<T, Growth>::~MappedArray() {
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::map(size_t bytes) {
+    int prot = mode_ == Mode::ReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
+    void* ptr;
+
+#ifdef MREMAP_MAYMOVE
+    if (base_ != nullptr) {
+        ptr = mremap(base_, mappedBytes_, bytes, MREMAP_MAYMOVE);
+    } else {
+        ptr = mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+    }
+#else
+    unmap();
+    ptr = mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+#endif
+
+    if (ptr == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "MappedArray: mmap failed");
+    }
+    base_ = (char*)ptr;
+    mappedBytes_ = bytes;
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::unmap() {
+    if (base_ != nullptr) {
+        munmap(base_, mappedBytes_);
+        base_ = nullptr;
+        mappedBytes_ = 0;
+    }
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::checkWritable() const {
+    if (mode_ == Mode::ReadOnly) {
+        throw std::logic_error("MappedArray is read-only");
+    }
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::reserve(size_type newCapacity) {
+    checkWritable();
+    if (newCapacity > capacity()) {
+        size_t bytes = headerSize + sizeof(T) * newCapacity;
+        if (ftruncate(fd_, bytes) != 0) {
+            throw std::system_error(errno, std::generic_category(), "MappedArray: cannot grow file");
+        }
+        map(bytes);
+    }
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::size_type MappedArray<T, Growth>::push_back(const T& value) {
+    emplace_back(value);
+    return size() - 1;
+}
+
+template<typename T, typename Growth>
+template<typename... Args>
+inline T& MappedArray<T, Growth>::emplace_back(Args&&... args) {
+    checkWritable();
+    if (size() == capacity()) {
+        // args may refer to an element of the mapping, which can move when the file grows
+        T value(std::forward<Args>(args)...);
+        reserve(Growth::grow(capacity(), size() + 1, sizeof(T)));
+        new (data() + size()) T(value);
+    } else {
+        new (data() + size()) T(std::forward<Args>(args)...);
+    }
+    Header* header = (Header*)base_;
+    return data()[header->size++];
+}
+
+template<typename T, typename Growth>
+template<std::input_iterator InputIt>
+inline void MappedArray<T, Growth>::append(InputIt first, InputIt last) {
+    checkWritable();
+    if constexpr (std::forward_iterator<InputIt>) {
+        size_type count = std::distance(first, last);
+        if (size() + count > capacity()) {
+            reserve(Growth::grow(capacity(), size() + count, sizeof(T)));
+        }
+        std::uninitialized_copy(first, last, data() + size());
+        ((Header*)base_)->size += count;
+    } else {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::resize(size_type newSize) {
+    checkWritable();
+    if (newSize > capacity()) {
+        reserve(newSize);
+    }
+    if (newSize > size()) {
+        std::memset((void*)(data() + size()), 0, sizeof(T) * (newSize - size()));
+    }
+    ((Header*)base_)->size = newSize;
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::clear() {
+    checkWritable();
+    ((Header*)base_)->size = 0;
+}
+
+template<typename T, typename Growth>
+inline void MappedArray<T, Growth>::flush(bool async) {
+    if (mode_ == Mode::ReadOnly) return;
+    if (msync(base_, mappedBytes_, async ? MS_ASYNC : MS_SYNC) != 0) {
+        throw std::system_error(errno, std::generic_category(), "MappedArray: msync failed");
+    }
+}
+
+template<typename T, typename Growth>
+inline const T& MappedArray<T, Growth>::operator[](size_type index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    return data()[index];
+}
+
+template<typename T, typename Growth>
+inline T& MappedArray<T, Growth>::operator[](size_type index) {
+    checkWritable();
+    if (index >= size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    return data()[index];
+}
+
+template<typename T, typename Growth>
+inline MappedArray<T, Growth>& MappedArray<T, Growth>::operator=(MappedArray&& other) {
+    if (this == &other) return *this;
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = other.fd_;
+    mode_ = other.mode_;
+    base_ = other.base_;
+    mappedBytes_ = other.mappedBytes_;
+    other.fd_ = -1;
+    other.base_ = nullptr;
+    other.mappedBytes_ = 0;
+    return *this;
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::size_type MappedArray<T, Growth>::size() const {
+    return base_ ? ((const Header*)base_)->size : 0;
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::size_type MappedArray<T, Growth>::capacity() const {
+    return base_ ? (mappedBytes_ - headerSize) / sizeof(T) : 0;
+}
+
+template<typename T, typename Growth>
+inline bool MappedArray<T, Growth>::readOnly() const {
+    return mode_ == Mode::ReadOnly;
+}
+
+template<typename T, typename Growth>
+inline T* MappedArray<T, Growth>::data() {
+    checkWritable();
+    return base_ ? (T*)(base_ + headerSize) : nullptr;
+}
+
+template<typename T, typename Growth>
+inline const T* MappedArray<T, Growth>::data() const {
+    return base_ ? (const T*)(base_ + headerSize) : nullptr;
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::Iterator MappedArray<T, Growth>::begin() {
+    checkWritable();
+    return data();
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::ConstIterator MappedArray<T, Growth>::cbegin() const {
+    return data();
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::Iterator MappedArray<T, Growth>::end() {
+    checkWritable();
+    return data() + size();
+}
+
+template<typename T, typename Growth>
+inline typename MappedArray<T, Growth>::ConstIterator MappedArray<T, Growth>::cend() const {
+    return data() + size();
+}
+
+#endif // MAPPEDARRAY_H
@@ -0,0 +1,137 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "IntroSort.h"
+#include "ThreadPool.h"
+
+// Ranges below this are sorted by the calling task with the sequential ssort.
+#define PARALLEL_SORT_CUTOFF 16384
+// Smallest block a parallel partition hands to one task.
+#define PARALLEL_PARTITION_BLOCK 65536
+
+// Partitions [begin, end) by pred on up to `blocks` tasks and returns the first element for
+// which pred is false. Each task partitions its own block; afterwards the elements on the
+// wrong side of the split point are swapped across, again spread evenly over the tasks.
+template<typename Iter, typename Pred>
+Iter parallelPartition(Iter begin, Iter end, Pred pred, ThreadPool& pool, size_t blocks) {
+    using Diff = std::iter_difference_t<Iter>;
+    Diff n = end - begin;
+
+    std::vector<Diff> mids(blocks);
+    TaskGroup group;
+    for (size_t b = 0; b < blocks; b++) {
+        Diff lo = n * b / blocks, hi = n * (b + 1) / blocks;
+        pool.run(group, [=, &pred, &mids] {
+            mids[b] = std::partition(begin + lo, begin + hi, pred) - begin;
+        });
+    }
+    pool.wait(group);
+
+    Diff split = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        split += mids[b] - n * b / blocks;
+    }
+
+    // false runs left of the split and true runs right of it, with prefix sums of their lengths
+    std::vector<std::pair<Diff, Diff>> high, low;
+    std::vector<Diff> highStart{0}, lowStart{0};
+    for (size_t b = 0; b < blocks; b++) {
+        Diff lo = n * b / blocks, hi = n * (b + 1) / blocks;
+        if (mids[b] < std::min(hi, split)) {
+            high.emplace_back(mids[b], std::min(hi, split));
+            highStart.push_back(highStart.back() + std::min(hi, split) - mids[b]);
+        }
+        if (std::max(lo, split) < mids[b]) {
+            low.emplace_back(std::max(lo, split), mids[b]);
+            lowStart.push_back(lowStart.back() + mids[b] - std::max(lo, split));
+        }
+    }
+
+    Diff misplaced = highStart.back();
+    if (misplaced == 0) return begin + split;
+
+    // position of the k-th misplaced element in a run list
+    auto locate = [](const std::vector<Diff>& start, Diff k) {
+        size_t run = std::upper_bound(start.begin(), start.end(), k) - start.begin() - 1;
+        return std::make_pair(run, k - start[run]);
+    };
+
+    size_t chunks = std::min<Diff>(blocks, misplaced);
+    for (size_t c = 0; c < chunks; c++) {
+        Diff first = misplaced * c / chunks, last = misplaced * (c + 1) / chunks;
+        pool.run(group, [=, &high, &low, &highStart, &lowStart] {
+            auto [h, hOffset] = locate(highStart, first);
+            auto [l, lOffset] = locate(lowStart, first);
+            for (Diff k = first; k < last; k++) {
+                if (high[h].first + hOffset == high[h].second) {
+                    h++;
+                    hOffset = 0;
+                }
+                if (low[l].first + lOffset == low[l].second) {
+                    l++;
+                    lOffset = 0;
+                }
+                std::iter_swap(begin + (high[h].first + hOffset++), begin + (low[l].first + lOffset++));
+            }
+        });
+    }
+    pool.wait(group);
+
+    return begin + split;
+}
+
+template<typename Iter, typename Compare>
+void parallelIntrosort(Iter begin, Iter end, Compare comp, int maxdepth, ThreadPool& pool, TaskGroup& group) {
+    auto n = std::distance(begin, end);
+    // leaves, a single thread and too many bad partitions all go to the sequential ssort,
+    // which picks radix, SIMD or string sorting where they apply and bounds its own worst case
+    if (n < PARALLEL_SORT_CUTOFF || pool.size() == 1 || maxdepth == 0) {
+        ssort(begin, end, comp);
+        return;
+    }
+
+    choosePivot(begin, end, comp);
+    Iter lower, upper;
+    size_t blocks = std::min<size_t>(pool.size(), n / PARALLEL_PARTITION_BLOCK);
+
+    if (blocks > 1) {
+        // the pivot stays at *begin while the rest is split into less / not less, then it is
+        // swapped to the boundary and the equal keys are split off the upper part
+        lower = parallelPartition(begin + 1, end, [&](const auto& x) { return comp(x, *begin); }, pool, blocks) - 1;
+        std::iter_swap(begin, lower);
+        blocks = std::min<size_t>(pool.size(), (end - lower) / PARALLEL_PARTITION_BLOCK);
+        if (blocks > 1) {
+            upper = parallelPartition(lower + 1, end, [&](const auto& x) { return !comp(*lower, x); }, pool, blocks);
+        } else {
+            upper = std::partition(lower + 1, end, [&](const auto& x) { return !comp(*lower, x); });
+        }
+    } else {
+        std::tie(lower, upper) = ::partition(begin, end, comp);
+    }
+
+    pool.run(group, [=, &pool, &group] {
+        parallelIntrosort(begin, lower, comp, maxdepth - 1, pool, group);
+    });
+    parallelIntrosort(upper, end, comp, maxdepth - 1, pool, group);
+}
+
+// Parallel ssort: both sides of every partition above PARALLEL_SORT_CUTOFF become tasks on
+// pool, and partitions large enough to fill several PARALLEL_PARTITION_BLOCKs are themselves
+// split across the pool. Needs random access iterators; the comparator is shared by all tasks
+// and must be safe to call concurrently.
+template<typename Iter, typename Compare>
+void ssort(ThreadPool& pool, Iter begin, Iter end, Compare comp) {
+    if (std::distance(begin, end) < 2) return;
+    int maxdepth = std::floor(std::log(std::distance(begin, end)) / std::log(2)) * 2;
+    TaskGroup group;
+    parallelIntrosort(begin, end, comp, maxdepth, pool, group);
+    pool.wait(group);
+}
+
+#endif // PARALLELSORT_H
@@ -0,0 +1,215 @@
+#ifndef PRIORITYQUEUE_H
+#define PRIORITYQUEUE_H
+
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "Array.h"
+#include "IntroSort.h"
+
+// Binary heap on an Array with handles: push() returns a handle that stays valid while the
+// element is queued, so a scheduler can move a queued task forward (decreaseKey), reprioritize
+// it either way (update) or cancel it (erase). top() is the element that comes first in comp
+// order, the smallest with std::less, like the earliest deadline of a timer queue. The heap is
+// kept by the siftUp/siftDown/siftToLeaf of IntroSort.h, which report every position they move
+// an element to so the handle table follows. pop() uses Floyd's bounce like heapsort.
+template<typename T, typename Compare = std::less<T>>
+class PriorityQueue final {
+public:
+    using size_type = size_t;
+    using Handle = size_t;
+
+    explicit PriorityQueue(Compare comp = Compare());
+
+    Handle push(const T& value);
+    Handle push(T&& value);
+    template<typename... Args>
+    Handle emplace(Args&&... args);
+
+    const T& top() const;
+    Handle topHandle() const;
+    void pop();
+
+    const T& get(Handle handle) const;
+    bool contains(Handle handle) const;
+    // value must not come after the current one in comp order
+    void decreaseKey(Handle handle, T value);
+    void update(Handle handle, T value);
+    void erase(Handle handle);
+
+    void reserve(size_type newCapacity);
+    void clear();
+
+    size_type size() const;
+    bool empty() const;
+
+private:
+    struct Entry {
+        T value;
+        Handle handle;
+    };
+
+    static constexpr size_type notQueued = size_type(-1);
+
+    // heap order: the max-heap functions put the element that comes first in comp at the root
+    auto later() const {
+        return [this](const Entry& a, const Entry& b) { return comp_(b.value, a.value); };
+    }
+    auto placed() {
+        return [this](size_type index) { positions_[heap_[index].handle] = index; };
+    }
+
+    Handle allocateHandle();
+    void remove(size_type index);
+    size_type position(Handle handle) const;
+
+    Array<Entry> heap_;
+    // heap index of every handle, notQueued for free handles
+    Array<size_type> positions_;
+    Array<Handle> freeHandles_;
+    Compare comp_;
+};
+
+template<typename T, typename Compare>
+inline PriorityQueue<T, Compare>::PriorityQueue(Compare comp) : comp_(comp) {
+}
+
+template<typename T, typename Compare>
+inline typename PriorityQueue<T, Compare>::Handle PriorityQueue<T, Compare>::push(const T& value) {
+    return emplace(value);
+}
+
+template<typename T, typename Compare>
+inline typename PriorityQueue<T, Compare>::Handle PriorityQueue<T, Compare>::push(T&& value) {
+    return emplace(std::move(value));
+}
+
+template<typename T, typename Compare>
+template<typename... Args>
+inline typename PriorityQueue<T, Compare>::Handle PriorityQueue<T, Compare>::emplace(Args&&... args) {
+    Handle handle = allocateHandle();
+    heap_.push_back(Entry{ T(std::forward<Args>(args)...), handle });
+    siftUp(heap_.begin(), heap_.size() - 1, later(), placed());
+    return handle;
+}
+
+template<typename T, typename Compare>
+inline typename PriorityQueue<T, Compare>::Handle PriorityQueue<T, Compare>::allocateHandle() {
+    if (freeHandles_.size() != 0) {
+        Handle handle = freeHandles_[freeHandles_.size() - 1];
+        freeHandles_.remove(freeHandles_.size() - 1);
+        return handle;
+    }
+    positions_.push_back(notQueued);
+    return positions_.size() - 1;
+}
+
+template<typename T, typename Compare>
+inline const T& PriorityQueue<T, Compare>::top() const {
+    if (heap_.size() == 0) {
+        throw std::out_of_range("PriorityQueue: top of an empty queue");
+    }
+    return heap_[0].value;
+}
+
+template<typename T, typename Compare>
+inline typename PriorityQueue<T, Compare>::Handle PriorityQueue<T, Compare>::topHandle() const {
+    if (heap_.size() == 0) {
+        throw std::out_of_range("PriorityQueue: top of an empty queue");
+    }
+    return heap_[0].handle;
+}
+
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::pop() {
+    if (heap_.size() == 0) {
+        throw std::out_of_range("PriorityQueue: pop from an empty queue");
+    }
+    remove(0);
+}
+
+// Fills the position of the removed element like heapsort does: the hole goes down to a leaf
+// and the last element moves into it and up. Below the root the last element may also belong
+// above the hole, which the sift up covers as well.
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::remove(size_type index) {
+    positions_[heap_[index].handle] = notQueued;
+    freeHandles_.push_back(heap_[index].handle);
+
+    size_type last = heap_.size() - 1;
+    if (index != last) {
+        Entry entry = std::move(heap_[last]);
+        auto leaf = siftToLeaf(heap_.begin(), last, index, later(), placed());
+        heap_[leaf] = std::move(entry);
+        siftUp(heap_.begin(), leaf, later(), placed());
+    }
+    heap_.remove(last);
+}
+
+template<typename T, typename Compare>
+inline typename PriorityQueue<T, Compare>::size_type PriorityQueue<T, Compare>::position(Handle handle) const {
+    if (!contains(handle)) {
+        throw std::out_of_range("PriorityQueue: handle is not queued");
+    }
+    return positions_[handle];
+}
+
+template<typename T, typename Compare>
+inline const T& PriorityQueue<T, Compare>::get(Handle handle) const {
+    return heap_[position(handle)].value;
+}
+
+template<typename T, typename Compare>
+inline bool PriorityQueue<T, Compare>::contains(Handle handle) const {
+    return handle < positions_.size() && positions_[handle] != notQueued;
+}
+
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::decreaseKey(Handle handle, T value) {
+    size_type index = position(handle);
+    heap_[index].value = std::move(value);
+    siftUp(heap_.begin(), index, later(), placed());
+}
+
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::update(Handle handle, T value) {
+    size_type index = position(handle);
+    bool earlier = comp_(value, heap_[index].value);
+    heap_[index].value = std::move(value);
+    if (earlier) {
+        siftUp(heap_.begin(), index, later(), placed());
+    } else {
+        siftDown(heap_.begin(), heap_.size(), index, later(), placed());
+    }
+}
+
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::erase(Handle handle) {
+    remove(position(handle));
+}
+
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::reserve(size_type newCapacity) {
+    heap_.reserve(newCapacity);
+    positions_.reserve(newCapacity);
+}
+
+template<typename T, typename Compare>
+inline void PriorityQueue<T, Compare>::clear() {
+    heap_.clear();
+    positions_.clear();
+    freeHandles_.clear();
+}
+
+template<typename T, typename Compare>
+inline typename PriorityQueue<T, Compare>::size_type PriorityQueue<T, Compare>::size() const {
+    return heap_.size();
+}
+
+template<typename T, typename Compare>
+inline bool PriorityQueue<T, Compare>::empty() const {
+    return heap_.size() == 0;
+}
+
+#endif // PRIORITYQUEUE_H
@@ -0,0 +1,201 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+// Radix sorts on arithmetic keys, 8 bits per pass. radixSort() is an LSD sort into a scratch
+// Array and is stable; msdRadixSort() permutes in place (American flag sort) and needs no
+// memory. Both take a key functor, so records are sorted by a field without a comparator,
+// and both skip digits that every key shares: 64-bit keys in a narrow range only pay for the
+// digits that differ. ssort() switches to radixSort() for arithmetic elements ordered by
+// std::less or std::greater when radixSortFaster() says so.
+
+// Below this many elements comparison sorting wins.
+#define RADIX_SORT_THRESHOLD 256
+// Above this many elements the SIMD kernels beat radixSort even on 32-bit keys: the scatter of
+// each pass no longer stays in cache.
+#define RADIX_SORT_SIMD_LIMIT (1 << 19)
+// msdRadixSort finishes buckets below this size with introsort.
+#define MSD_RADIX_CUTOFF 64
+
+// defined in IntroSort.h
+template<typename Iter, typename Compare>
+void introsort(Iter begin, Iter end, Compare comp, int maxdepth);
+
+template<typename K>
+concept RadixKey = (std::is_integral_v<K> && !std::is_same_v<K, bool>)
+                   || (std::is_floating_point_v<K> && (sizeof(K) == 4 || sizeof(K) == 8));
+
+// Ranges ssort() hands to radixSort(): random access, arithmetic elements, std::less or
+// std::greater.
+template<typename Iter, typename Compare>
+concept RadixSortable = std::random_access_iterator<Iter> && RadixKey<std::iter_value_t<Iter>>
+                        && (std::is_same_v<Compare, std::less<std::iter_value_t<Iter>>> || std::is_same_v<Compare, std::less<>>
+                            || std::is_same_v<Compare, std::greater<std::iter_value_t<Iter>>> || std::is_same_v<Compare, std::greater<>>);
+
+// Maps key to an unsigned integer of the same width with the same order. Signed integers get
+// their sign bit flipped. Floats get every bit flipped when negative and the sign bit otherwise,
+// which puts -0.0 before 0.0 and NaNs beyond the infinity of their sign.
+template<RadixKey K>
+constexpr auto radixBits(K key) {
+    if constexpr (std::is_floating_point_v<K>) {
+        using Bits = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+        Bits bits = std::bit_cast<Bits>(key);
+        Bits sign = Bits(1) << (sizeof(K) * 8 - 1);
+        return (bits & sign) ? Bits(~bits) : Bits(bits | sign);
+    } else if constexpr (std::is_signed_v<K>) {
+        using Bits = std::make_unsigned_t<K>;
+        return Bits(Bits(key) ^ (Bits(1) << (sizeof(K) * 8 - 1)));
+    } else {
+        return key;
+    }
+}
+
+// Key functor ssort() passes for comp: the element itself, or its bits inverted for
+// std::greater.
+template<typename T, typename Compare>
+auto radixKeyFor(Compare) {
+    if constexpr (std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::greater<>>) {
+        return [](const T& value) { return decltype(radixBits(value))(~radixBits(value)); };
+    } else {
+        return [](const T& value) { return value; };
+    }
+}
+
+// Whether radixSort() beats the comparison sort ssort() would use otherwise for n keys of type T,
+// simd telling whether that is simdSort(). Against the SIMD kernels only keys up to 32 bits win,
+// wider keys need too many passes.
+template<RadixKey T>
+bool radixSortFaster(size_t n, bool simd) {
+    if (n < RADIX_SORT_THRESHOLD) return false;
+    return !simd || (sizeof(T) <= 4 && n <= RADIX_SORT_SIMD_LIMIT);
+}
+
+template<typename From, typename To, typename Key>
+void radixScatter(From from, From to, To out, Key& key, int shift, size_t* offsets) {
+    for (; from != to; ++from) {
+        out[offsets[(radixBits(key(*from)) >> shift) & 255]++] = std::move(*from);
+    }
+}
+
+// LSD radix sort of [begin, end) by key(element), stable. scratch is grown to the range size if
+// it is smaller and otherwise left as it is, so sorts that share a scratch Array allocate once.
+template<std::random_access_iterator Iter, typename Key>
+void radixSort(Iter begin, Iter end, Key key, Array<std::iter_value_t<Iter>>& scratch) {
+    using Bits = decltype(radixBits(key(*begin)));
+    constexpr int digits = sizeof(Bits);
+    size_t n = end - begin;
+    if (n < 2) return;
+
+    // histograms of every digit in one read
+    size_t counts[digits][256] = {};
+    for (Iter it = begin; it != end; ++it) {
+        Bits bits = radixBits(key(*it));
+        for (int d = 0; d < digits; d++) {
+            counts[d][(bits >> (8 * d)) & 255]++;
+        }
+    }
+
+    if (scratch.size() < n) {
+        scratch.resize_for_overwrite(n);
+    }
+    auto buffer = scratch.data();
+    bool inScratch = false;
+
+    for (int d = 0; d < digits; d++) {
+        if (std::find(counts[d], counts[d] + 256, n) != counts[d] + 256) continue;
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += counts[d][b];
+        }
+        if (inScratch) {
+            radixScatter(buffer, buffer + n, begin, key, 8 * d, offsets);
+        } else {
+            radixScatter(begin, end, buffer, key, 8 * d, offsets);
+        }
+        inScratch = !inScratch;
+    }
+
+    if (inScratch) {
+        std::move(buffer, buffer + n, begin);
+    }
+}
+
+template<std::random_access_iterator Iter, typename Key>
+void radixSort(Iter begin, Iter end, Key key) {
+    Array<std::iter_value_t<Iter>> scratch;
+    radixSort(begin, end, key, scratch);
+}
+
+template<std::random_access_iterator Iter, typename Key>
+void msdRadixSort(Iter begin, Iter end, Key key, int digit) {
+    auto digitOf = [&](const auto& value) { return size_t(radixBits(key(value)) >> (8 * digit)) & 255; };
+    size_t n = end - begin;
+
+    if (n < MSD_RADIX_CUTOFF) {
+        introsort(begin, end, [&](const auto& a, const auto& b) { return radixBits(key(a)) < radixBits(key(b)); }, 16);
+        return;
+    }
+
+    size_t counts[256];
+    for (;;) {
+        std::fill(counts, counts + 256, 0);
+        for (Iter it = begin; it != end; ++it) {
+            counts[digitOf(*it)]++;
+        }
+        if (std::find(counts, counts + 256, n) == counts + 256) break;
+        // every key has the same digit here
+        if (digit-- == 0) return;
+    }
+
+    size_t heads[256], tails[256];
+    size_t sum = 0;
+    for (int b = 0; b < 256; b++) {
+        heads[b] = sum;
+        sum += counts[b];
+        tails[b] = sum;
+    }
+
+    // cycle leader: carry each misplaced element to the next free slot of its bucket and pick up
+    // the one found there, until an element for the bucket being filled comes back
+    for (size_t b = 0; b < 256; b++) {
+        while (heads[b] < tails[b]) {
+            std::iter_value_t<Iter> value = std::move(begin[heads[b]]);
+            for (size_t d = digitOf(value); d != b; d = digitOf(value)) {
+                std::iter_value_t<Iter> found = std::move(begin[heads[d]]);
+                begin[heads[d]++] = std::move(value);
+                value = std::move(found);
+            }
+            begin[heads[b]++] = std::move(value);
+        }
+    }
+
+    if (digit == 0) return;
+    size_t start = 0;
+    for (int b = 0; b < 256; b++) {
+        if (tails[b] - start > 1) {
+            msdRadixSort(begin + start, begin + tails[b], key, digit - 1);
+        }
+        start = tails[b];
+    }
+}
+
+// In-place MSD radix sort of [begin, end) by key(element), unstable.
+template<std::random_access_iterator Iter, typename Key>
+void msdRadixSort(Iter begin, Iter end, Key key) {
+    if (end - begin < 2) return;
+    msdRadixSort(begin, end, key, int(sizeof(radixBits(key(*begin)))) - 1);
+}
+
+#endif // RADIXSORT_H
@@ -0,0 +1,410 @@
+#ifndef SEGMENTEDARRAY_H
+#define SEGMENTEDARRAY_H
+
+#include <cstdlib>
+#include <bit>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+// Array made of fixed-size chunks of ChunkSize elements. Growing only allocates a new chunk and
+// appends its pointer to the chunk table, so push_back never copies elements, its worst case is
+// one malloc instead of an O(n) reallocation, and references to elements stay valid for the
+// lifetime of the element. Iterators are random access and also survive push_back.
+template<typename T, size_t ChunkSize = 1024>
+class SegmentedArray final {
+    static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+public:
+    using size_type = size_t;
+
+    template<bool Const>
+    class BasicIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using array_pointer = std::conditional_t<Const, const SegmentedArray*, SegmentedArray*>;
+
+        BasicIterator();
+        BasicIterator(size_type index, array_pointer array);
+        template<bool OtherConst> requires (Const && !OtherConst)
+        BasicIterator(const BasicIterator<OtherConst>& other);
+
+        bool operator==(const BasicIterator& other) const;
+        bool operator!=(const BasicIterator& other) const;
+        bool operator<(const BasicIterator& other) const;
+        bool operator>(const BasicIterator& other) const;
+        bool operator<=(const BasicIterator& other) const;
+        bool operator>=(const BasicIterator& other) const;
+        BasicIterator& operator++();
+        BasicIterator operator++(int);
+        BasicIterator& operator--();
+        BasicIterator operator--(int);
+        reference operator*() const;
+        pointer operator->() const;
+        BasicIterator& operator+=(ptrdiff_t n);
+        BasicIterator& operator-=(ptrdiff_t n);
+        ptrdiff_t operator-(const BasicIterator& other) const;
+        BasicIterator operator-(ptrdiff_t n) const;
+        BasicIterator operator+(ptrdiff_t n) const;
+        reference operator[](ptrdiff_t n) const;
+
+        friend BasicIterator operator+(ptrdiff_t n, const BasicIterator& iter) {
+            return iter + n;
+        }
+
+    private:
+        template<bool>
+        friend class BasicIterator;
+
+        size_type index_;
+        array_pointer array_;
+    };
+
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    SegmentedArray();
+    SegmentedArray(const SegmentedArray& other);
+    SegmentedArray(SegmentedArray&& other);
+    ~SegmentedArray();
+
+    void reserve(size_type newCapacity);
+    size_type push_back(const T& value);
+    size_type push_back(T&& value);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+    void pop_back();
+    void clear();
+
+    const T& operator[](size_type index) const;
+    T& operator[](size_type index);
+
+    SegmentedArray& operator=(const SegmentedArray& other);
+    SegmentedArray& operator=(SegmentedArray&& other);
+
+    size_type size() const;
+    size_type capacity() const;
+
+    Iterator begin();
+    ConstIterator cbegin() const;
+    Iterator end();
+    ConstIterator cend() const;
+
+private:
+    static constexpr size_type shift = std::countr_zero(ChunkSize);
+    static constexpr size_type mask = ChunkSize - 1;
+
+    T& at(size_type index);
+    const T& at(size_type index) const;
+    void addChunk();
+    void release();
+
+    Array<T*> chunks_;
+    size_type size_;
+};
+
+template<typename T, size_t ChunkSize>
+inline SegmentedArray<T, ChunkSize>::SegmentedArray() : chunks_(), size_(0) {
+}
+
+template<typename T, size_t ChunkSize>
+inline SegmentedArray<T, ChunkSize>::SegmentedArray(const SegmentedArray& other) : chunks_(), size_(0) {
+    *this = other;
+}
+
+template<typename T, size_t ChunkSize>
+inline SegmentedArray<T, ChunkSize>::SegmentedArray(SegmentedArray&& other) : chunks_(), size_(0) {
+    *this = std::move(other);
+}
+
+template<typename T, size_t ChunkSize>
+inline SegmentedArray<T, ChunkSize>::~SegmentedArray() {
+    release();
+}
+
+template<typename T, size_t ChunkSize>
+inline void SegmentedArray<T, ChunkSize>::release() {
+    clear();
+    for (size_type i = 0; i < chunks_.size(); i++) {
+        free(chunks_[i]);
+    }
+    chunks_.clear();
+}
+
+template<typename T, size_t ChunkSize>
+inline T& SegmentedArray<T, ChunkSize>::at(size_type index) {
+    return chunks_.data()[index >> shift][index & mask];
+}
+
+template<typename T, size_t ChunkSize>
+inline const T& SegmentedArray<T, ChunkSize>::at(size_type index) const {
+    return chunks_.data()[index >> shift][index & mask];
+}
+
+template<typename T, size_t ChunkSize>
+inline void SegmentedArray<T, ChunkSize>::addChunk() {
+    T* chunk = (T*)malloc(sizeof(T) * ChunkSize);
+    if (chunk == nullptr) throw std::bad_alloc();
+    try {
+        chunks_.push_back(chunk);
+    } catch (...) {
+        free(chunk);
+        throw;
+    }
+}
+
+template<typename T, size_t ChunkSize>
+inline void SegmentedArray<T, ChunkSize>::reserve(size_type newCapacity) {
+    while (capacity() < newCapacity) {
+        addChunk();
+    }
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::size_type SegmentedArray<T, ChunkSize>::push_back(const T& value) {
+    emplace_back(value);
+    return size_ - 1;
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::size_type SegmentedArray<T, ChunkSize>::push_back(T&& value) {
+    emplace_back(std::move(value));
+    return size_ - 1;
+}
+
+template<typename T, size_t ChunkSize>
+template<typename... Args>
+inline T& SegmentedArray<T, ChunkSize>::emplace_back(Args&&... args) {
+    if (size_ == capacity()) {
+        // existing chunks never move, so args can safely refer to one of our elements
+        addChunk();
+    }
+    T* ptr = &at(size_);
+    new (ptr) T(std::forward<Args>(args)...);
+    size_++;
+    return *ptr;
+}
+
+template<typename T, size_t ChunkSize>
+inline void SegmentedArray<T, ChunkSize>::pop_back() {
+    if (size_ == 0) {
+        throw std::out_of_range("");
+    }
+    at(--size_).~T();
+}
+
+template<typename T, size_t ChunkSize>
+inline void SegmentedArray<T, ChunkSize>::clear() {
+    while (size_ > 0) {
+        at(--size_).~T();
+    }
+}
+
+template<typename T, size_t ChunkSize>
+inline const T& SegmentedArray<T, ChunkSize>::operator[](size_type index) const {
+    if (index >= size_) {
+        throw std::out_of_range("Index out of range");
+    }
+    return at(index);
+}
+
+template<typename T, size_t ChunkSize>
+inline T& SegmentedArray<T, ChunkSize>::operator[](size_type index) {
+    if (index >= size_) {
+        throw std::out_of_range("Index out of range");
+    }
+    return at(index);
+}
+
+template<typename T, size_t ChunkSize>
+inline SegmentedArray<T, ChunkSize>& SegmentedArray<T, ChunkSize>::operator=(const SegmentedArray& other) {
+    if (this == &other) return *this;
+    clear();
+    reserve(other.size_);
+    for (size_type i = 0; i < other.size_; i++) {
+        new (&at(i)) T(other.at(i));
+        size_++;
+    }
+    return *this;
+}
+
+template<typename T, size_t ChunkSize>
+inline SegmentedArray<T, ChunkSize>& SegmentedArray<T, ChunkSize>::operator=(SegmentedArray&& other) {
+    if (this == &other) return *this;
+    release();
+    chunks_ = std::move(other.chunks_);
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::size_type SegmentedArray<T, ChunkSize>::size() const {
+    return size_;
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::size_type SegmentedArray<T, ChunkSize>::capacity() const {
+    return chunks_.size() * ChunkSize;
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::Iterator SegmentedArray<T, ChunkSize>::begin() {
+    return Iterator(0, this);
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::ConstIterator SegmentedArray<T, ChunkSize>::cbegin() const {
+    return ConstIterator(0, this);
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::Iterator SegmentedArray<T, ChunkSize>::end() {
+    return Iterator(size_, this);
+}
+
+template<typename T, size_t ChunkSize>
+inline typename SegmentedArray<T, ChunkSize>::ConstIterator SegmentedArray<T, ChunkSize>::cend() const {
+    return ConstIterator(size_, this);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline SegmentedArray<T, ChunkSize>::BasicIterator<Const>::BasicIterator() : index_(0), array_(nullptr) {}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline SegmentedArray<T, ChunkSize>::BasicIterator<Const>::BasicIterator(size_type index, array_pointer array) : index_(index), array_(array) {}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+template<bool OtherConst> requires (Const && !OtherConst)
+inline SegmentedArray<T, ChunkSize>::BasicIterator<Const>::BasicIterator(const BasicIterator<OtherConst>& other) : index_(other.index_), array_(other.array_) {}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline bool SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator==(const BasicIterator& other) const {
+    return index_ == other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline bool SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator!=(const BasicIterator& other) const {
+    return index_ != other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline bool SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator<(const BasicIterator& other) const {
+    return index_ < other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline bool SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator>(const BasicIterator& other) const {
+    return index_ > other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline bool SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator<=(const BasicIterator& other) const {
+    return index_ <= other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline bool SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator>=(const BasicIterator& other) const {
+    return index_ >= other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>& SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator++() {
+    ++index_;
+    return *this;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const> SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator++(int) {
+    BasicIterator iter(*this);
+    ++index_;
+    return iter;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>& SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator--() {
+    --index_;
+    return *this;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const> SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator--(int) {
+    BasicIterator iter(*this);
+    --index_;
+    return iter;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>::reference SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator*() const {
+    return array_->at(index_);
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>::pointer SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator->() const {
+    return &array_->at(index_);
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>& SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator+=(ptrdiff_t n) {
+    index_ += n;
+    return *this;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>& SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator-=(ptrdiff_t n) {
+    index_ -= n;
+    return *this;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline ptrdiff_t SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator-(const BasicIterator& other) const {
+    return (ptrdiff_t)index_ - (ptrdiff_t)other.index_;
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const> SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator-(ptrdiff_t n) const {
+    return BasicIterator(index_ - n, array_);
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const> SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator+(ptrdiff_t n) const {
+    return BasicIterator(index_ + n, array_);
+}
+
+template<typename T, size_t ChunkSize>
+template<bool Const>
+inline typename SegmentedArray<T, ChunkSize>::template BasicIterator<Const>::reference SegmentedArray<T, ChunkSize>::BasicIterator<Const>::operator[](ptrdiff_t n) const {
+    return array_->at(index_ + n);
+}
+
+#endif // SEGMENTEDARRAY_H
@@ -0,0 +1,172 @@
+#ifndef SELECT_H
+#define SELECT_H
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "Array.h"
+#include "IntroSort.h"
+
+// Selection on the introsort machinery: choosePivot() and the three-way ::partition() narrow
+// the range down to the wanted position instead of sorting both sides, and heapify()/siftDown()
+// keep the bounded heap of TopK.
+
+// Group size of the median-of-medians pivot.
+#define MEDIAN_GROUP 5
+
+template<typename Iter, typename Compare>
+void introselect(Iter begin, Iter nth, Iter end, Compare comp, int maxdepth);
+
+template<typename Iter, typename Compare>
+void medianOfMedians(Iter begin, Iter end, Compare comp);
+
+// Rearranges [begin, end) so that *nth is the element a full sort would put there, nothing
+// before it is above it and nothing after it is below it. Expected O(n); like introsort falls
+// back to heapsort, a range still unresolved after 2 log2(n) partitions switches to the
+// median-of-medians pivot, which bounds the worst case at O(n) too.
+template<typename Iter, typename Compare>
+void selectNth(Iter begin, Iter nth, Iter end, Compare comp) {
+    if (nth == end || std::distance(begin, end) < 2) return;
+    introselect(begin, nth, end, comp, 2 * std::bit_width(size_t(std::distance(begin, end))));
+}
+
+// Sorts the first middle - begin elements a full sort would produce into [begin, middle); the
+// order of the rest is unspecified. O(n + k log k) for k = middle - begin.
+template<typename Iter, typename Compare>
+void partialSort(Iter begin, Iter middle, Iter end, Compare comp) {
+    if (begin == middle) return;
+    selectNth(begin, middle - 1, end, comp);
+    ssort(begin, middle - 1, comp);
+}
+
+template<typename Iter, typename Compare>
+void introselect(Iter begin, Iter nth, Iter end, Compare comp, int maxdepth) {
+    while (std::distance(begin, end) >= SORT_THRESHOLD) {
+        if (maxdepth == 0) {
+            medianOfMedians(begin, end, comp);
+        } else {
+            choosePivot(begin, end, comp);
+            maxdepth--;
+        }
+
+        auto [lower, upper] = ::partition(begin, end, comp);
+        if (nth < lower) {
+            end = lower;
+        } else if (nth >= upper) {
+            begin = upper;
+        } else {
+            return;
+        }
+    }
+    insertionsort(begin, end, comp);
+}
+
+// Moves to begin the median of the medians of groups of MEDIAN_GROUP elements, found with
+// introselect at depth 0, i.e. again by median of medians. At least 3/10 of the range lies on
+// either side of it.
+template<typename Iter, typename Compare>
+void medianOfMedians(Iter begin, Iter end, Compare comp) {
+    Iter medians = begin;
+    for (Iter group = begin; group != end; ) {
+        Iter groupEnd = group + std::min<std::iter_difference_t<Iter>>(MEDIAN_GROUP, end - group);
+        insertionsort(group, groupEnd, comp);
+        std::iter_swap(medians++, group + (groupEnd - group) / 2);
+        group = groupEnd;
+    }
+
+    Iter median = begin + (medians - begin) / 2;
+    introselect(begin, median, medians, comp, 0);
+    std::iter_swap(begin, median);
+}
+
+// Streaming top-k: keeps the k elements that come first in comp order (the k smallest with
+// std::less, the k largest with std::greater) of everything pushed, in a bounded heap whose
+// root is the worst element kept. Once k elements are in, a push costs one comparison when the
+// element does not make the cut and O(log k) when it does.
+template<typename T, typename Compare = std::less<T>>
+class TopK final {
+public:
+    explicit TopK(size_t k, Compare comp = Compare());
+
+    void push(const T& value);
+    void push(T&& value);
+    template<std::input_iterator InputIt>
+    void push(InputIt first, InputIt last);
+
+    size_t size() const;
+    // the k-th best element pushed so far; only valid once k elements were pushed
+    const T& worst() const;
+
+    // Returns the elements kept, sorted by comp, and starts over.
+    Array<T> take();
+
+private:
+    template<typename U>
+    void offer(U&& value);
+
+    Array<T> heap_;
+    size_t k_;
+    Compare comp_;
+};
+
+template<typename T, typename Compare>
+inline TopK<T, Compare>::TopK(size_t k, Compare comp) : k_(k), comp_(comp) {
+    heap_.reserve(k);
+}
+
+template<typename T, typename Compare>
+inline void TopK<T, Compare>::push(const T& value) {
+    offer(value);
+}
+
+template<typename T, typename Compare>
+inline void TopK<T, Compare>::push(T&& value) {
+    offer(std::move(value));
+}
+
+template<typename T, typename Compare>
+template<std::input_iterator InputIt>
+inline void TopK<T, Compare>::push(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        offer(*first);
+    }
+}
+
+template<typename T, typename Compare>
+template<typename U>
+inline void TopK<T, Compare>::offer(U&& value) {
+    if (heap_.size() < k_) {
+        heap_.push_back(std::forward<U>(value));
+        // a heap only pays off once it is full and elements start being rejected
+        if (heap_.size() == k_) {
+            heapify(heap_.begin(), heap_.end(), comp_);
+        }
+    } else if (k_ != 0 && comp_(value, heap_[0])) {
+        heap_[0] = std::forward<U>(value);
+        siftDown(heap_.begin(), heap_.size(), 0, comp_);
+    }
+}
+
+template<typename T, typename Compare>
+inline size_t TopK<T, Compare>::size() const {
+    return heap_.size();
+}
+
+template<typename T, typename Compare>
+inline const T& TopK<T, Compare>::worst() const {
+    return heap_[0];
+}
+
+template<typename T, typename Compare>
+inline Array<T> TopK<T, Compare>::take() {
+    Array<T> result(std::move(heap_));
+    heap_ = Array<T>();
+    heap_.reserve(k_);
+    ssort(result.begin(), result.end(), comp_);
+    return result;
+}
+
+#endif // SELECT_H
@@ -0,0 +1,392 @@
+#ifndef SIMDSORT_H
+#define SIMDSORT_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+// SIMD sorting kernels for 32 and 64 bit signed integers, float and double sorted with
+// std::less. ssort() in IntroSort.h hands such ranges to simdSort(): ranges of up to
+// SIMD_SORT_REGISTERS vectors are sorted with an in-register bitonic network, larger ones are
+// split by a vectorized partition (AVX-512 compress-store, or an AVX2 permutation table)
+// around the same pivot introsort would use. The instruction set is picked at run time from
+// the CPU; without AVX2, or when built with SIMD_SORT 0, simdSort() returns false and ssort
+// runs the scalar introsort. NaNs are moved to the end of the range first, in no particular
+// order; the rest is sorted, -0.0 and 0.0 as equal keys.
+
+#ifndef SIMD_SORT
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_SORT 1
+#else
+#define SIMD_SORT 0
+#endif
+#endif
+
+// Vectors per block sorted by the bitonic network: 64 32-bit or 32 64-bit keys.
+#define SIMD_SORT_REGISTERS 8
+
+#if SIMD_SORT
+#include <immintrin.h>
+
+#define SIMD_AVX2_INLINE [[gnu::target("avx2"), gnu::always_inline]] static inline
+#define SIMD_AVX512_INLINE [[gnu::target("avx512f"), gnu::always_inline]] static inline
+#endif
+
+// defined in IntroSort.h
+template<typename Iter, typename Compare>
+void choosePivot(Iter begin, Iter end, Compare comp);
+
+template<typename Iter, typename Compare>
+void heapsort(Iter begin, Iter end, Compare comp);
+
+template<typename T>
+concept SimdSortKey = (std::is_integral_v<T> && std::is_signed_v<T> && (sizeof(T) == 4 || sizeof(T) == 8))
+                      || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Ranges ssort() hands to simdSort(): contiguous SimdSortKeys ordered by std::less.
+template<typename Iter, typename Compare>
+concept SimdSortable = std::contiguous_iterator<Iter> && SimdSortKey<std::iter_value_t<Iter>>
+                       && (std::is_same_v<Compare, std::less<std::iter_value_t<Iter>>> || std::is_same_v<Compare, std::less<>>);
+
+enum class SimdLevel { Scalar, Avx2, Avx512 };
+
+// Best instruction set of this CPU, detected once.
+inline SimdLevel simdLevel() {
+#if SIMD_SORT
+    static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SimdLevel::Avx512
+                                 : __builtin_cpu_supports("avx2") ? SimdLevel::Avx2
+                                 : SimdLevel::Scalar;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// Sorts [begin, end) ascending with the kernels of level, which must not exceed simdLevel().
+// Returns false without touching the range when level is Scalar.
+template<SimdSortKey T>
+bool simdSort(T* begin, T* end, SimdLevel level = simdLevel());
+
+template<SimdSortKey T>
+constexpr T simdSortPadding() {
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+template<bool OrEqual, typename T>
+size_t scalarPartition(T* a, size_t n, T pivot) {
+    return std::partition(a, a + n, [pivot](T x) { return OrEqual ? !(pivot < x) : x < pivot; }) - a;
+}
+
+#if SIMD_SORT
+
+// Entry m is the permutation, four bits per 32-bit word, that moves the elements whose bit is
+// set in m to the front of a 256-bit vector of Lanes elements and the others behind them.
+template<int Lanes>
+constexpr std::array<uint32_t, 1 << Lanes> simdCompressTable() {
+    constexpr int words = 8 / Lanes;
+    std::array<uint32_t, 1 << Lanes> table{};
+
+    for (int m = 0; m < (1 << Lanes); m++) {
+        int out = 0;
+        for (int selected = 1; selected >= 0; selected--) {
+            for (int i = 0; i < Lanes; i++) {
+                if (((m >> i) & 1) != selected) continue;
+                for (int w = 0; w < words; w++) {
+                    table[m] |= uint32_t(i * words + w) << (4 * out++);
+                }
+            }
+        }
+    }
+    return table;
+}
+
+template<SimdSortKey T>
+struct Avx2Ops {
+    using Vec = __m256i;
+    static constexpr int lanes = 32 / sizeof(T);
+    static constexpr std::array<uint32_t, 1 << lanes> compress = simdCompressTable<lanes>();
+
+    SIMD_AVX2_INLINE Vec load(const T* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    SIMD_AVX2_INLINE void store(T* p, Vec v) { _mm256_storeu_si256((__m256i*)p, v); }
+
+    SIMD_AVX2_INLINE Vec set1(T x) {
+        if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(std::bit_cast<int32_t>(x));
+        else return _mm256_set1_epi64x(std::bit_cast<int64_t>(x));
+    }
+
+    // lanes where a < b
+    SIMD_AVX2_INLINE Vec less(Vec a, Vec b) {
+        if constexpr (std::is_same_v<T, float>) return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_LT_OQ));
+        else if constexpr (std::is_same_v<T, double>) return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_LT_OQ));
+        else if constexpr (sizeof(T) == 4) return _mm256_cmpgt_epi32(b, a);
+        else return _mm256_cmpgt_epi64(b, a);
+    }
+
+    // Both keep a where the lanes are equal, so min(a, b) and max(b, a) take a lane each from
+    // different registers and a compare-exchange permutes. _mm256_min_ps and _mm256_max_ps
+    // return b for -0.0 and 0.0 and would write one of them into both registers.
+    SIMD_AVX2_INLINE Vec min(Vec a, Vec b) {
+        if constexpr (std::is_integral_v<T> && sizeof(T) == 4) return _mm256_min_epi32(a, b);
+        else return _mm256_blendv_epi8(a, b, less(b, a));
+    }
+
+    SIMD_AVX2_INLINE Vec max(Vec a, Vec b) {
+        if constexpr (std::is_integral_v<T> && sizeof(T) == 4) return _mm256_max_epi32(a, b);
+        else return _mm256_blendv_epi8(a, b, less(a, b));
+    }
+
+    // bit i is set when lane i is below pivot, or with OrEqual not above it
+    template<bool OrEqual>
+    SIMD_AVX2_INLINE unsigned below(Vec v, Vec pivot) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(v), _mm256_castsi256_ps(pivot), OrEqual ? _CMP_LE_OQ : _CMP_LT_OQ));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(v), _mm256_castsi256_pd(pivot), OrEqual ? _CMP_LE_OQ : _CMP_LT_OQ));
+        } else {
+            Vec gt = OrEqual ? (sizeof(T) == 4 ? _mm256_cmpgt_epi32(v, pivot) : _mm256_cmpgt_epi64(v, pivot))
+                             : (sizeof(T) == 4 ? _mm256_cmpgt_epi32(pivot, v) : _mm256_cmpgt_epi64(pivot, v));
+            unsigned m = sizeof(T) == 4 ? _mm256_movemask_ps(_mm256_castsi256_ps(gt)) : _mm256_movemask_pd(_mm256_castsi256_pd(gt));
+            return OrEqual ? ~m & ((1u << lanes) - 1) : m;
+        }
+    }
+
+    // lanes whose bit is set in bits are taken from b, the others from a
+    SIMD_AVX2_INLINE Vec blend(Vec a, Vec b, unsigned bits) {
+        Vec bit = sizeof(T) == 4 ? _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128) : _mm256_setr_epi32(1, 1, 2, 2, 4, 4, 8, 8);
+        return _mm256_blendv_epi8(a, b, _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), bit), bit));
+    }
+
+    // lane i gets lane i ^ j
+    SIMD_AVX2_INLINE Vec swapLanes(Vec v, int j) {
+        Vec index = _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(j * 8 / lanes));
+        return _mm256_permutevar8x32_epi32(v, index);
+    }
+
+    // Writes the lanes below pivot to left and the others to right - their count, advancing
+    // both. Stores a full vector at each end, so both sides need a vector of free space.
+    template<bool OrEqual>
+    SIMD_AVX2_INLINE void partitionStore(Vec v, Vec pivot, T*& left, T*& right) {
+        unsigned m = below<OrEqual>(v, pivot);
+        int count = std::popcount(m);
+        Vec index = _mm256_srlv_epi32(_mm256_set1_epi32(compress[m]), _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28));
+        v = _mm256_permutevar8x32_epi32(v, _mm256_and_si256(index, _mm256_set1_epi32(15)));
+        store(left, v);
+        store(right - lanes, v);
+        left += count;
+        right -= lanes - count;
+    }
+};
+
+template<SimdSortKey T>
+struct Avx512Ops {
+    using Vec = __m512i;
+    static constexpr int lanes = 64 / sizeof(T);
+
+    SIMD_AVX512_INLINE Vec load(const T* p) { return _mm512_loadu_si512(p); }
+
+    SIMD_AVX512_INLINE Vec set1(T x) {
+        if constexpr (sizeof(T) == 4) return _mm512_set1_epi32(std::bit_cast<int32_t>(x));
+        else return _mm512_set1_epi64(std::bit_cast<int64_t>(x));
+    }
+
+    template<bool OrEqual>
+    SIMD_AVX512_INLINE unsigned below(Vec v, Vec pivot) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_cmp_ps_mask(_mm512_castsi512_ps(v), _mm512_castsi512_ps(pivot), OrEqual ? _CMP_LE_OQ : _CMP_LT_OQ);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm512_cmp_pd_mask(_mm512_castsi512_pd(v), _mm512_castsi512_pd(pivot), OrEqual ? _CMP_LE_OQ : _CMP_LT_OQ);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_cmp_epi32_mask(v, pivot, OrEqual ? _MM_CMPINT_LE : _MM_CMPINT_LT);
+        } else {
+            return _mm512_cmp_epi64_mask(v, pivot, OrEqual ? _MM_CMPINT_LE : _MM_CMPINT_LT);
+        }
+    }
+
+    // Same contract as Avx2Ops::partitionStore, but compress-store writes only the lanes of
+    // each side.
+    template<bool OrEqual>
+    SIMD_AVX512_INLINE void partitionStore(Vec v, Vec pivot, T*& left, T*& right) {
+        unsigned m = below<OrEqual>(v, pivot);
+        int count = std::popcount(m);
+        if constexpr (sizeof(T) == 4) {
+            _mm512_mask_compressstoreu_epi32(left, m, v);
+            _mm512_mask_compressstoreu_epi32(right - (lanes - count), ~m, v);
+        } else {
+            _mm512_mask_compressstoreu_epi64(left, m, v);
+            _mm512_mask_compressstoreu_epi64(right - (lanes - count), ~m, v);
+        }
+        left += count;
+        right -= lanes - count;
+    }
+};
+
+// The partition loop of both instruction sets. It needs a target attribute of its own, so it
+// is stamped out per instruction set by SIMD_PARTITION below.
+//
+// Partitions [a, a + n) in place and returns the number of elements below pivot. One vector
+// from each end is set aside first; after that every vector is read from the end with less
+// room left, which keeps a vector of free space on both sides for partitionStore(). The tail
+// shorter than a vector is partitioned one element at a time, and the two vectors set aside
+// fill the remaining gap.
+#define SIMD_PARTITION(Name, Target, Ops)                                               \
+    template<SimdSortKey T, bool OrEqual>                                               \
+    [[gnu::target(Target)]] size_t Name(T* a, size_t n, T pivot) {                      \
+        using Vec = typename Ops<T>::Vec;                                               \
+        constexpr size_t lanes = Ops<T>::lanes;                                         \
+        if (n < 2 * lanes) return scalarPartition<OrEqual>(a, n, pivot);                \
+                                                                                        \
+        Vec p = Ops<T>::set1(pivot);                                                    \
+        Vec first = Ops<T>::load(a), last = Ops<T>::load(a + n - lanes);                \
+        T* left = a;                                                                    \
+        T* right = a + n;                                                               \
+        T* readLeft = a + lanes;                                                        \
+        T* readRight = a + n - lanes;                                                   \
+                                                                                        \
+        while (size_t(readRight - readLeft) >= lanes) {                                 \
+            Vec v;                                                                      \
+            if (readLeft - left <= right - readRight) {                                 \
+                v = Ops<T>::load(readLeft);                                             \
+                readLeft += lanes;                                                      \
+            } else {                                                                    \
+                readRight -= lanes;                                                     \
+                v = Ops<T>::load(readRight);                                            \
+            }                                                                           \
+            Ops<T>::template partitionStore<OrEqual>(v, p, left, right);                \
+        }                                                                               \
+                                                                                        \
+        T tail[lanes];                                                                  \
+        size_t rest = readRight - readLeft;                                             \
+        std::memcpy(tail, readLeft, rest * sizeof(T));                                  \
+        for (size_t i = 0; i < rest; i++) {                                             \
+            if (OrEqual ? !(pivot < tail[i]) : tail[i] < pivot) *left++ = tail[i];      \
+            else *--right = tail[i];                                                    \
+        }                                                                               \
+        Ops<T>::template partitionStore<OrEqual>(first, p, left, right);                \
+        Ops<T>::template partitionStore<OrEqual>(last, p, left, right);                 \
+        return left - a;                                                                \
+    }
+
+SIMD_PARTITION(avx2Partition, "avx2", Avx2Ops)
+SIMD_PARTITION(avx512Partition, "avx512f", Avx512Ops)
+
+#undef SIMD_PARTITION
+
+// Sorts n <= SIMD_SORT_REGISTERS * lanes keys with a bitonic network over that many vectors,
+// padding the block with the largest key. Compare-exchanges between lanes further apart than
+// a vector are a min/max of two registers; closer ones swap lanes within each register and
+// blend the min and max back by position. Also used on AVX-512 CPUs, where a 64-key block
+// is too small for wider vectors to pay off.
+template<SimdSortKey T>
+[[gnu::target("avx2")]] void avx2SortBlock(T* a, size_t n) {
+    using Ops = Avx2Ops<T>;
+    using Vec = typename Ops::Vec;
+    constexpr int lanes = Ops::lanes;
+    constexpr int size = SIMD_SORT_REGISTERS * lanes;
+
+    T block[size];
+    std::memcpy(block, a, n * sizeof(T));
+    std::fill(block + n, block + size, simdSortPadding<T>());
+
+    Vec v[SIMD_SORT_REGISTERS];
+    for (int r = 0; r < SIMD_SORT_REGISTERS; r++) {
+        v[r] = Ops::load(block + r * lanes);
+    }
+
+    for (int k = 2; k <= size; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            if (j >= lanes) {
+                for (int r = 0; r < SIMD_SORT_REGISTERS; r++) {
+                    int s = r ^ (j / lanes);
+                    if (s < r) continue;
+                    Vec lo = Ops::min(v[r], v[s]), hi = Ops::max(v[s], v[r]);
+                    bool ascending = ((r * lanes) & k) == 0;
+                    v[r] = ascending ? lo : hi;
+                    v[s] = ascending ? hi : lo;
+                }
+                continue;
+            }
+
+            // lane i keeps the max when it is the upper of its pair in an ascending run
+            unsigned upper = 0;
+            for (int i = 0; i < lanes; i++) {
+                upper |= unsigned(((i & j) != 0) != (k < lanes && (i & k) != 0)) << i;
+            }
+            for (int r = 0; r < SIMD_SORT_REGISTERS; r++) {
+                bool descending = k >= lanes && ((r * lanes) & k) != 0;
+                Vec swapped = Ops::swapLanes(v[r], j);
+                v[r] = Ops::blend(Ops::min(v[r], swapped), Ops::max(v[r], swapped),
+                                  descending ? ~upper & ((1u << lanes) - 1) : upper);
+            }
+        }
+    }
+
+    for (int r = 0; r < SIMD_SORT_REGISTERS; r++) {
+        Ops::store(block + r * lanes, v[r]);
+    }
+    std::memcpy(a, block, n * sizeof(T));
+}
+
+template<SimdSortKey T>
+struct SimdKernels {
+    size_t (*partitionBelow)(T*, size_t, T);
+    size_t (*partitionNotAbove)(T*, size_t, T);
+    void (*sortBlock)(T*, size_t);
+};
+
+// introsort on the SIMD kernels. floor, when not null, is a key no element of the range is
+// below (the pivot of the enclosing partition); a pivot equal to it means the range starts
+// with copies of that key, so they are split off in one pass and never recursed into.
+template<SimdSortKey T>
+void simdIntrosort(T* begin, T* end, const SimdKernels<T>& kernels, int maxdepth, const T* floor) {
+    size_t n = end - begin;
+    if (n <= SIMD_SORT_REGISTERS * 32 / sizeof(T)) {
+        kernels.sortBlock(begin, n);
+    }
+    else if (maxdepth == 0) {
+        heapsort(begin, end, std::less<T>());
+    }
+    else {
+        choosePivot(begin, end, std::less<T>());
+        T pivot = *begin;
+        if (floor != nullptr && !(*floor < pivot)) {
+            simdIntrosort(begin + kernels.partitionNotAbove(begin, n, pivot), end, kernels, maxdepth - 1, floor);
+            return;
+        }
+        T* mid = begin + kernels.partitionBelow(begin, n, pivot);
+        simdIntrosort(begin, mid, kernels, maxdepth - 1, floor);
+        simdIntrosort(mid, end, kernels, maxdepth - 1, &pivot);
+    }
+}
+
+#undef SIMD_AVX2_INLINE
+#undef SIMD_AVX512_INLINE
+
+#endif // SIMD_SORT
+
+template<SimdSortKey T>
+bool simdSort(T* begin, T* end, SimdLevel level) {
+#if SIMD_SORT
+    static const SimdKernels<T> avx2 = { avx2Partition<T, false>, avx2Partition<T, true>, avx2SortBlock<T> };
+    static const SimdKernels<T> avx512 = { avx512Partition<T, false>, avx512Partition<T, true>, avx2SortBlock<T> };
+
+    if (level == SimdLevel::Scalar) return false;
+    if constexpr (std::is_floating_point_v<T>) {
+        // NaNs are unordered with everything, including the padding of sortBlock
+        end = std::partition(begin, end, [](T x) { return x == x; });
+    }
+    if (end - begin < 2) return true;
+    int maxdepth = std::bit_width(size_t(end - begin)) * 2;
+    simdIntrosort(begin, end, level == SimdLevel::Avx512 ? avx512 : avx2, maxdepth, (const T*)nullptr);
+    return true;
+#else
+    return false;
+#endif
+}
+
+#endif // SIMDSORT_H
@@ -0,0 +1,332 @@
+#ifndef SOAARRAY_H
+#define SOAARRAY_H
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+// Structure-of-arrays container: every field of a record is stored in its own Array, so a scan
+// over one field only touches that field's memory. Records are accessed through Reference, a
+// proxy for one slot in every column. Iterator is a random access iterator over those
+// proxies, which lets ssort reorder all columns at once:
+//
+//     ssort(records.begin(), records.end(), records.byColumn<0>(std::less<>()));
+template<typename... Fields>
+class SoAArray final {
+public:
+    using size_type = size_t;
+    using value_type = std::tuple<Fields...>;
+
+    class Reference {
+    public:
+        Reference(std::tuple<Fields*...> base, size_type index);
+        Reference(const Reference& other) = default;
+
+        template<size_t I>
+        auto& get() const { return std::get<I>(base_)[index_]; }
+
+        operator value_type() const;
+        const Reference& operator=(const value_type& value) const;
+        const Reference& operator=(const Reference& other) const;
+
+        friend void swap(Reference a, Reference b) {
+            a.swapWith(b, std::index_sequence_for<Fields...>());
+        }
+
+    private:
+        template<size_t... I>
+        void assignFrom(const value_type& value, std::index_sequence<I...>) const;
+        template<size_t... I>
+        void swapWith(const Reference& other, std::index_sequence<I...>) const;
+
+        std::tuple<Fields*...> base_;
+        size_type index_;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = ptrdiff_t;
+        using reference = Reference;
+        using pointer = void;
+
+        Iterator();
+        Iterator(std::tuple<Fields*...> base, ptrdiff_t index);
+
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+        bool operator<(const Iterator& other) const;
+        bool operator>(const Iterator& other) const;
+        bool operator<=(const Iterator& other) const;
+        bool operator>=(const Iterator& other) const;
+        Iterator& operator++();
+        Iterator operator++(int);
+        Iterator& operator--();
+        Iterator operator--(int);
+        Reference operator*() const;
+        Iterator& operator+=(ptrdiff_t n);
+        Iterator& operator-=(ptrdiff_t n);
+        ptrdiff_t operator-(const Iterator& other) const;
+        Iterator operator-(ptrdiff_t n) const;
+        Iterator operator+(ptrdiff_t n) const;
+        Reference operator[](ptrdiff_t n) const;
+
+        friend Iterator operator+(ptrdiff_t n, const Iterator& iter) {
+            return iter + n;
+        }
+
+    private:
+        std::tuple<Fields*...> base_;
+        ptrdiff_t index_;
+    };
+
+    SoAArray() = default;
+
+    void reserve(size_type newCapacity);
+    size_type push_back(const Fields&... values);
+    void resize(size_type newSize);
+    void clear();
+
+    Reference operator[](size_type index);
+    value_type operator[](size_type index) const;
+
+    size_type size() const;
+
+    template<size_t I>
+    std::span<std::tuple_element_t<I, value_type>> column();
+    template<size_t I>
+    std::span<const std::tuple_element_t<I, value_type>> column() const;
+
+    template<size_t I, typename Compare>
+    static auto byColumn(Compare comp);
+
+    Iterator begin();
+    Iterator end();
+
+private:
+    std::tuple<Fields*...> bases();
+
+    std::tuple<Array<Fields>...> columns_;
+};
+
+template<typename... Fields>
+inline SoAArray<Fields...>::Reference::Reference(std::tuple<Fields*...> base, size_type index) : base_(base), index_(index) {}
+
+template<typename... Fields>
+inline SoAArray<Fields...>::Reference::operator value_type() const {
+    return std::apply([this](Fields*... base) { return value_type(base[index_]...); }, base_);
+}
+
+template<typename... Fields>
+inline const typename SoAArray<Fields...>::Reference& SoAArray<Fields...>::Reference::operator=(const value_type& value) const {
+    assignFrom(value, std::index_sequence_for<Fields...>());
+    return *this;
+}
+
+template<typename... Fields>
+inline const typename SoAArray<Fields...>::Reference& SoAArray<Fields...>::Reference::operator=(const Reference& other) const {
+    return *this = value_type(other);
+}
+
+template<typename... Fields>
+template<size_t... I>
+inline void SoAArray<Fields...>::Reference::assignFrom(const value_type& value, std::index_sequence<I...>) const {
+    ((std::get<I>(base_)[index_] = std::get<I>(value)), ...);
+}
+
+template<typename... Fields>
+template<size_t... I>
+inline void SoAArray<Fields...>::Reference::swapWith(const Reference& other, std::index_sequence<I...>) const {
+    using std::swap;
+    (swap(std::get<I>(base_)[index_], std::get<I>(other.base_)[other.index_]), ...);
+}
+
+template<typename... Fields>
+inline void SoAArray<Fields...>::reserve(size_type newCapacity) {
+    std::apply([newCapacity](Array<Fields>&... column) { (column.reserve(newCapacity), ...); }, columns_);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::size_type SoAArray<Fields...>::push_back(const Fields&... values) {
+    return std::apply([&values...](Array<Fields>&... column) { return (column.push_back(values), ...); }, columns_);
+}
+
+template<typename... Fields>
+inline void SoAArray<Fields...>::resize(size_type newSize) {
+    std::apply([newSize](Array<Fields>&... column) { (column.resize(newSize), ...); }, columns_);
+}
+
+template<typename... Fields>
+inline void SoAArray<Fields...>::clear() {
+    std::apply([](Array<Fields>&... column) { (column.clear(), ...); }, columns_);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Reference SoAArray<Fields...>::operator[](size_type index) {
+    if (index >= size()) {
+        throw std::out_of_range("Index out of range");
+    }
+    return Reference(bases(), index);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::value_type SoAArray<Fields...>::operator[](size_type index) const {
+    return std::apply([index](const Array<Fields>&... column) { return value_type(column[index]...); }, columns_);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::size_type SoAArray<Fields...>::size() const {
+    return std::get<0>(columns_).size();
+}
+
+template<typename... Fields>
+template<size_t I>
+inline std::span<std::tuple_element_t<I, typename SoAArray<Fields...>::value_type>> SoAArray<Fields...>::column() {
+    auto& column = std::get<I>(columns_);
+    return { column.data(), column.size() };
+}
+
+template<typename... Fields>
+template<size_t I>
+inline std::span<const std::tuple_element_t<I, typename SoAArray<Fields...>::value_type>> SoAArray<Fields...>::column() const {
+    const auto& column = std::get<I>(columns_);
+    return { column.data(), column.size() };
+}
+
+template<typename... Fields>
+template<size_t I, typename Compare>
+inline auto SoAArray<Fields...>::byColumn(Compare comp) {
+    // sorts compare rows in place and rows they hold on to as values
+    auto field = [](const auto& row) -> decltype(auto) {
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(row)>, Reference>) {
+            return row.template get<I>();
+        } else {
+            return std::get<I>(row);
+        }
+    };
+    return [comp, field](const auto& a, const auto& b) { return comp(field(a), field(b)); };
+}
+
+template<typename... Fields>
+inline std::tuple<Fields*...> SoAArray<Fields...>::bases() {
+    return std::apply([](Array<Fields>&... column) { return std::tuple<Fields*...>(column.data()...); }, columns_);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator SoAArray<Fields...>::begin() {
+    return Iterator(bases(), 0);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator SoAArray<Fields...>::end() {
+    return Iterator(bases(), size());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename... Fields>
+inline SoAArray<Fields...>::Iterator::Iterator() : base_(), index_(0) {}
+
+template<typename... Fields>
+inline SoAArray<Fields...>::Iterator::Iterator(std::tuple<Fields*...> base, ptrdiff_t index) : base_(base), index_(index) {}
+
+template<typename... Fields>
+inline bool SoAArray<Fields...>::Iterator::operator==(const Iterator& other) const {
+    return index_ == other.index_;
+}
+
+template<typename... Fields>
+inline bool SoAArray<Fields...>::Iterator::operator!=(const Iterator& other) const {
+    return index_ != other.index_;
+}
+
+template<typename... Fields>
+inline bool SoAArray<Fields...>::Iterator::operator<(const Iterator& other) const {
+    return index_ < other.index_;
+}
+
+template<typename... Fields>
+inline bool SoAArray<Fields...>::Iterator::operator>(const Iterator& other) const {
+    return index_ > other.index_;
+}
+
+template<typename... Fields>
+inline bool SoAArray<Fields...>::Iterator::operator<=(const Iterator& other) const {
+    return index_ <= other.index_;
+}
+
+template<typename... Fields>
+inline bool SoAArray<Fields...>::Iterator::operator>=(const Iterator& other) const {
+    return index_ >= other.index_;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator& SoAArray<Fields...>::Iterator::operator++() {
+    ++index_;
+    return *this;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator SoAArray<Fields...>::Iterator::operator++(int) {
+    Iterator iter(*this);
+    ++index_;
+    return iter;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator& SoAArray<Fields...>::Iterator::operator--() {
+    --index_;
+    return *this;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator SoAArray<Fields...>::Iterator::operator--(int) {
+    Iterator iter(*this);
+    --index_;
+    return iter;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Reference SoAArray<Fields...>::Iterator::operator*() const {
+    return Reference(base_, index_);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator& SoAArray<Fields...>::Iterator::operator+=(ptrdiff_t n) {
+    index_ += n;
+    return *this;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator& SoAArray<Fields...>::Iterator::operator-=(ptrdiff_t n) {
+    index_ -= n;
+    return *this;
+}
+
+template<typename... Fields>
+inline ptrdiff_t SoAArray<Fields...>::Iterator::operator-(const Iterator& other) const {
+    return index_ - other.index_;
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator SoAArray<Fields...>::Iterator::operator-(ptrdiff_t n) const {
+    return Iterator(base_, index_ - n);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Iterator SoAArray<Fields...>::Iterator::operator+(ptrdiff_t n) const {
+    return Iterator(base_, index_ + n);
+}
+
+template<typename... Fields>
+inline typename SoAArray<Fields...>::Reference SoAArray<Fields...>::Iterator::operator[](ptrdiff_t n) const {
+    return Reference(base_, index_ + n);
+}
+
+#endif // SOAARRAY_H
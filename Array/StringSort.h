@@ -0,0 +1,197 @@
+#ifndef STRINGSORT_H
+#define STRINGSORT_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+// Sort for strings that never compares a prefix twice and hardly ever touches the strings.
+// Instead of the strings, an Array of (view, position) pairs is sorted by multikey quicksort
+// (Bentley and Sedgewick) on a cache of the next 8 characters of every string, packed big-endian
+// into an integer (Rantala's superalphabet caching): partitions compare cached integers, and only
+// the group of strings equal in all 8 characters goes back to the strings, once, to load the next
+// 8. Small groups are finished by insertion sort on the cached characters and the suffixes.
+// Every string is then moved once to its place. ssort() switches to stringSort() for
+// std::string and std::string_view ordered by std::less or std::greater.
+
+// Below this many strings comparison sorting wins.
+#define STRING_SORT_THRESHOLD 32
+// Groups below this size are sorted by insertion sort.
+#define STRING_INSERTION_CUTOFF 16
+
+// defined in IntroSort.h
+template<typename Iter, typename Key>
+void applyKeyOrder(Iter begin, Array<std::pair<Key, size_t>>& keys);
+
+template<typename T>
+concept StringKey = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+// Ranges ssort() hands to stringSort(): random access, strings, std::less or std::greater.
+template<typename Iter, typename Compare>
+concept StringSortable = std::random_access_iterator<Iter> && StringKey<std::iter_value_t<Iter>>
+                         && (std::is_same_v<Compare, std::less<std::iter_value_t<Iter>>> || std::is_same_v<Compare, std::less<>>
+                             || std::is_same_v<Compare, std::greater<std::iter_value_t<Iter>>> || std::is_same_v<Compare, std::greater<>>);
+
+using StringRef = std::pair<std::string_view, size_t>;
+
+// Characters depth to depth + 7 of s, big-endian, zeros past its end.
+inline uint64_t stringKeyAt(std::string_view s, size_t depth) {
+    uint64_t key = 0;
+    if (depth < s.size()) {
+        std::memcpy(&key, s.data() + depth, std::min<size_t>(8, s.size() - depth));
+    }
+    if constexpr (std::endian::native == std::endian::little) {
+        key = __builtin_bswap64(key);
+    }
+    return key;
+}
+
+inline void swapStringRefs(StringRef* refs, uint64_t* cache, size_t a, size_t b) {
+    std::swap(refs[a], refs[b]);
+    std::swap(cache[a], cache[b]);
+}
+
+// Every string of the group has the same first depth characters and its next 8 in cache.
+inline void stringInsertionsort(StringRef* refs, uint64_t* cache, size_t n, size_t depth) {
+    for (size_t i = 1; i < n; i++) {
+        StringRef value = refs[i];
+        uint64_t key = cache[i];
+        std::string_view suffix = value.first.substr(depth);
+        size_t j = i;
+        for (; j > 0 && (key < cache[j - 1] || (key == cache[j - 1] && suffix < refs[j - 1].first.substr(depth))); j--) {
+            refs[j] = refs[j - 1];
+            cache[j] = cache[j - 1];
+        }
+        refs[j] = value;
+        cache[j] = key;
+    }
+}
+
+inline void multikeyQuicksort(StringRef* refs, uint64_t* cache, size_t n, size_t depth);
+
+// Finishes a group whose strings agree in characters depth to depth + 7. Those that end within
+// them are prefixes of the others and differ from each other only in length, so they go first,
+// ordered by a counting sort on the length; the rest continue with the next 8 characters.
+inline void multikeyQuicksortEqual(StringRef* refs, uint64_t* cache, size_t n, size_t depth) {
+    size_t counts[9] = {};
+    size_t ended = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (refs[i].first.size() <= depth + 8) {
+            counts[refs[i].first.size() - depth]++;
+            swapStringRefs(refs, cache, i, ended++);
+        }
+    }
+    if (ended > 1) {
+        // by length, in place like msdRadixSort
+        size_t heads[9], tails[9];
+        size_t sum = 0;
+        for (int l = 0; l < 9; l++) {
+            heads[l] = sum;
+            sum += counts[l];
+            tails[l] = sum;
+        }
+        for (int l = 0; l < 9; l++) {
+            while (heads[l] < tails[l]) {
+                size_t length = refs[heads[l]].first.size() - depth;
+                if (int(length) == l) {
+                    heads[l]++;
+                } else {
+                    std::swap(refs[heads[l]], refs[heads[length]++]);
+                }
+            }
+        }
+    }
+
+    refs += ended;
+    cache += ended;
+    n -= ended;
+    if (n < 2) return;
+    depth += 8;
+    for (size_t i = 0; i < n; i++) {
+        cache[i] = stringKeyAt(refs[i].first, depth);
+    }
+    multikeyQuicksort(refs, cache, n, depth);
+}
+
+// Sorts the group by the characters from depth on, the next 8 of which are in cache.
+inline void multikeyQuicksort(StringRef* refs, uint64_t* cache, size_t n, size_t depth) {
+    while (n >= STRING_INSERTION_CUTOFF) {
+        uint64_t a = cache[0], b = cache[n / 2], c = cache[n - 1];
+        uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        // [0, lt) below the pivot, [lt, gt) equal to it, [gt, n) above it
+        size_t lt = 0, gt = n;
+        for (size_t i = 0; i < gt; ) {
+            if (cache[i] < pivot) {
+                swapStringRefs(refs, cache, lt++, i++);
+            } else if (cache[i] > pivot) {
+                swapStringRefs(refs, cache, i, --gt);
+            } else {
+                i++;
+            }
+        }
+
+        if (gt - lt > 1) {
+            multikeyQuicksortEqual(refs + lt, cache + lt, gt - lt, depth);
+        }
+        // recurse into the smaller side, loop on the larger
+        if (lt < n - gt) {
+            multikeyQuicksort(refs, cache, lt, depth);
+            refs += gt;
+            cache += gt;
+            n -= gt;
+        } else {
+            multikeyQuicksort(refs + gt, cache + gt, n - gt, depth);
+            n = lt;
+        }
+    }
+    stringInsertionsort(refs, cache, n, depth);
+}
+
+// Sorts refs by their views, the positions following along.
+inline void sortStringRefs(Array<StringRef>& refs, bool descending) {
+    size_t n = refs.size();
+    Array<uint64_t> cache;
+    cache.resize_for_overwrite(n);
+    for (size_t i = 0; i < n; i++) {
+        cache[i] = stringKeyAt(refs[i].first, 0);
+    }
+    multikeyQuicksort(refs.data(), cache.data(), n, 0);
+
+    if (descending) {
+        std::reverse(refs.data(), refs.data() + n);
+    }
+}
+
+template<typename Compare>
+constexpr bool stringSortDescending() {
+    return std::is_same_v<Compare, std::greater<std::string>> || std::is_same_v<Compare, std::greater<std::string_view>>
+           || std::is_same_v<Compare, std::greater<>>;
+}
+
+// Sorts [begin, end) of std::string or std::string_view by comp, std::less or std::greater,
+// moving every element once.
+template<typename Iter, typename Compare>
+    requires StringSortable<Iter, Compare>
+void stringSort(Iter begin, Iter end, Compare) {
+    Array<StringRef> refs;
+    refs.reserve(std::distance(begin, end));
+    size_t i = 0;
+    for (Iter it = begin; it != end; ++it) {
+        refs.emplace_back(std::string_view(*it), i++);
+    }
+
+    sortStringRefs(refs, stringSortDescending<Compare>());
+    applyKeyOrder(begin, refs);
+}
+
+#endif // STRINGSORT_H
@@ -0,0 +1,193 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Array.h"
+
+// Tasks submitted with ThreadPool::run() and waited for together.
+class TaskGroup final {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup& other) = delete;
+
+    TaskGroup& operator=(const TaskGroup& other) = delete;
+
+private:
+    friend class ThreadPool;
+
+    std::atomic<size_t> pending_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+};
+
+// Work-stealing pool. Every worker owns a deque: tasks submitted from a worker go to the back
+// of its own deque and it pops from the back, so nested tasks run depth-first and stay in
+// cache; an idle worker steals from the front of the others, taking the oldest (usually the
+// largest) piece of work. A pool of n threads starts n - 1 workers, the thread calling wait()
+// is the n-th: it runs tasks too until its group is done, so waiting inside a task never
+// blocks a worker.
+class ThreadPool final {
+public:
+    // threads == 0 uses one thread per hardware core
+    explicit ThreadPool(size_t threads = 0);
+    ThreadPool(const ThreadPool& other) = delete;
+    ~ThreadPool();
+
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    template<typename F>
+    void run(TaskGroup& group, F&& task);
+
+    // Runs queued tasks until every task of group has finished, then rethrows the first
+    // exception one of them threw.
+    void wait(TaskGroup& group);
+
+    size_t size() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    size_t self() const;
+    bool runOne(size_t self);
+    void work(size_t index);
+
+    Array<std::unique_ptr<Queue>> queues_;
+    Array<std::thread> threads_;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_;
+    bool stop_;
+
+    // the pool and queue of the worker running on this thread, if any
+    static thread_local const ThreadPool* currentPool_;
+    static thread_local size_t currentQueue_;
+};
+
+inline thread_local const ThreadPool* ThreadPool::currentPool_ = nullptr;
+inline thread_local size_t ThreadPool::currentQueue_ = 0;
+
+inline ThreadPool::ThreadPool(size_t threads) : queued_(0), stop_(false) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+    }
+    // one queue per worker plus a shared one for tasks submitted from outside the pool
+    for (size_t i = 0; i < threads; i++) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    threads_.reserve(threads - 1);
+    for (size_t i = 0; i + 1 < threads; i++) {
+        threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+inline size_t ThreadPool::size() const {
+    return threads_.size() + 1;
+}
+
+inline size_t ThreadPool::self() const {
+    return currentPool_ == this ? currentQueue_ : queues_.size() - 1;
+}
+
+template<typename F>
+inline void ThreadPool::run(TaskGroup& group, F&& task) {
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+    std::function<void()> wrapped = [&group, task = std::forward<F>(task)]() mutable {
+        try {
+            task();
+        } catch (...) {
+            if (!group.failed_.exchange(true)) {
+                group.error_ = std::current_exception();
+            }
+        }
+        group.pending_.fetch_sub(1, std::memory_order_release);
+    };
+
+    Queue& queue = *queues_[self()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(wrapped));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+}
+
+inline bool ThreadPool::runOne(size_t self) {
+    std::function<void()> task;
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    for (size_t i = 1; !task && i < queues_.size(); i++) {
+        Queue& victim = *queues_[(self + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+inline void ThreadPool::wait(TaskGroup& group) {
+    size_t queue = self();
+    while (group.pending_.load(std::memory_order_acquire) != 0) {
+        if (!runOne(queue)) {
+            // the rest of the group is running on other threads
+            std::this_thread::yield();
+        }
+    }
+    if (group.failed_.exchange(false)) {
+        std::rethrow_exception(std::exchange(group.error_, nullptr));
+    }
+}
+
+inline void ThreadPool::work(size_t index) {
+    currentPool_ = this;
+    currentQueue_ = index;
+
+    for (;;) {
+        if (runOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) != 0; });
+        if (stop_) return;
+    }
+}
+
+#endif // THREADPOOL_H
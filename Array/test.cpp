@@ -9,6 +9,30 @@ TEST(Array, ReserveTest) {
     ASSERT_EQ(array.capacity(), std_vector.capacity());
 }
 
+// Test case for Array class growth policies
+TEST(Array, GrowthPolicyTest) {
+    Array<int> doubling;
+    Array<int, HalfGrowth> half;
+    Array<int, PageGrowth> page;
+
+    for (int i = 0; i < 17; i++) {
+        doubling.push_back(i);
+        half.push_back(i);
+    }
+    for (int i = 0; i < 2000; i++) {
+        page.push_back(i);
+    }
+
+    ASSERT_EQ(doubling.capacity(), 32);
+    ASSERT_EQ(half.capacity(), 24);
+    ASSERT_EQ(page.capacity() * sizeof(int) % PageGrowth::pageSize, 0);
+
+    for (int i = 0; i < 17; i++) {
+        ASSERT_EQ(doubling[i], i);
+        ASSERT_EQ(half[i], i);
+    }
+}
+
 // Test case for Array class
 TEST(Array, PushBackTest) {
     Array<int> array;
@@ -30,6 +54,45 @@ TEST(Array, PushBackTest) {
     }
 }
 
+// Test case for Array class emplace_back and rvalue push_back
+TEST(Array, EmplaceBackTest) {
+    Array<std::string> array;
+    std::vector<std::string> std_vector{ "aaa", "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbb", "aaa" };
+
+    array.emplace_back(3, 'a');
+    std::string str(30, 'b');
+    array.push_back(std::move(str));
+    array.push_back(array[0]);
+
+    ASSERT_EQ(array.size(), std_vector.size());
+
+    for (size_t i = 0; i < array.size(); ++i) {
+        ASSERT_EQ(array[i], std_vector[i]);
+    }
+}
+
+// Test case for Array class range append, assign, resize and clear
+TEST(Array, RangeTest) {
+    Array<int> array{1, 2};
+    std::vector<int> std_vector{3, 4, 5};
+
+    array.append(std_vector.begin(), std_vector.end());
+    ASSERT_EQ(array.size(), 5);
+    ASSERT_TRUE(std::equal(array.begin(), array.end(), std::vector<int>{1, 2, 3, 4, 5}.begin()));
+
+    array.resize(7, 9);
+    ASSERT_EQ(array[6], 9);
+    array.resize(2);
+    ASSERT_EQ(array.size(), 2);
+
+    array.assign(std_vector.begin(), std_vector.end());
+    ASSERT_TRUE(std::equal(array.begin(), array.end(), std_vector.begin()));
+
+    array.clear();
+    ASSERT_EQ(array.size(), 0);
+    ASSERT_NE(array.capacity(), 0);
+}
+
 // Test case for Array class insert method
 TEST(Array, InsertTest) {
     Array<int> array{1, 2};
@@ -58,6 +121,41 @@ TEST(Array, RemoveTest) {
     }
 }
 
+// Test case for Array class range insert, erase and erase_if
+TEST(Array, BulkInsertEraseTest) {
+    Array<int> array{1, 2, 6};
+    std::vector<int> std_vector{3, 4, 5};
+
+    array.insert(2, std_vector.begin(), std_vector.end());
+    array.insert(0, array.begin() + 1, array.begin() + 3);
+    ASSERT_TRUE(std::equal(array.begin(), array.end(), std::vector<int>{2, 3, 1, 2, 3, 4, 5, 6}.begin()));
+
+    array.erase(array.begin(), array.begin() + 2);
+    ASSERT_EQ(array.size(), 6);
+    ASSERT_EQ(array.erase_if([](int a) { return a % 2 == 0; }), 3);
+    ASSERT_TRUE(std::equal(array.begin(), array.end(), std::vector<int>{1, 3, 5}.begin()));
+
+    Array<std::string> strings{ "sort", "array" };
+    std::vector<std::string> std_strings{ "a", "b", "c" };
+    strings.insert(1, std_strings.begin(), std_strings.end());
+    strings.erase(strings.begin() + 3, strings.end());
+    ASSERT_TRUE(std::equal(strings.begin(), strings.end(), std::vector<std::string>{ "sort", "a", "b" }.begin()));
+    ASSERT_EQ(strings.erase_if([](const std::string& s) { return s.size() == 1; }), 2);
+    ASSERT_EQ(strings.size(), 1);
+
+    // append, assign and assign(count, value) from the array itself
+    strings = Array<std::string>{ "a", "b", "c", "d" };
+    ASSERT_EQ(strings.capacity(), strings.size());
+    strings.append(strings.begin(), strings.end());
+    ASSERT_TRUE(std::equal(strings.begin(), strings.end(), std::vector<std::string>{ "a", "b", "c", "d", "a", "b", "c", "d" }.begin()));
+    strings.assign(strings.begin() + 1, strings.begin() + 3);
+    ASSERT_EQ(strings.size(), 2);
+    ASSERT_TRUE(std::equal(strings.begin(), strings.end(), std::vector<std::string>{ "b", "c" }.begin()));
+    strings.assign(3, strings[1]);
+    ASSERT_EQ(strings.size(), 3);
+    ASSERT_TRUE(std::all_of(strings.begin(), strings.end(), [](const std::string& s) { return s == "c"; }));
+}
+
 // Test case for Array class iterator methods
 TEST(Array, IteratorTest) {
     Array<int> array{1, 2, 3};
@@ -76,6 +174,21 @@ TEST(Array, IteratorTest) {
     ASSERT_EQ(sum_array, sum_std_vector);
 }
 
+// Test case for Array class contiguous iterators
+TEST(Array, ContiguousIteratorTest) {
+    static_assert(std::contiguous_iterator<Array<int>::Iterator>);
+    static_assert(std::contiguous_iterator<Array<int>::ConstIterator>);
+
+    Array<int> array{5, 3, 4, 1, 2};
+    std::vector<int> std_vector{1, 2, 3, 4, 5};
+
+    std::sort(array.begin(), array.end());
+
+    ASSERT_EQ(std::to_address(array.begin()), array.data());
+    ASSERT_EQ(array.end() - array.begin(), 5);
+    ASSERT_TRUE(std::equal(array.cbegin(), array.cend(), std_vector.begin()));
+}
+
 // Test case for Array class copy assignment
 TEST(Array, CopyAssignmentTest) {
     Array<int> array{1, 2, 3};
@@ -192,6 +305,849 @@ TEST(Array, VecSortTime) {
     //std::sort(std_vector.begin(), std_vector.end());
 }
 
+// Test case for sorting inputs that defeat a naive pivot choice
+TEST(Array, SortDistributionTime) {
+    const int n = 1000000;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::uniform_int_distribution<int> few(0, 1000);
+
+    std::vector<std::pair<std::string, std::vector<int>>> inputs;
+    std::vector<int> input(n);
+    for (int& value : input) value = dist(gen);
+    inputs.emplace_back("random", input);
+    for (int& value : input) value = few(gen);
+    inputs.emplace_back("few unique", input);
+    std::iota(input.begin(), input.end(), 0);
+    inputs.emplace_back("sorted", input);
+    std::reverse(input.begin(), input.end());
+    inputs.emplace_back("reversed", input);
+    for (int i = 0; i < n; i++) input[i] = i < n / 2 ? i : n - i;
+    inputs.emplace_back("organ pipe", input);
+    std::fill(input.begin(), input.end(), 7);
+    inputs.emplace_back("all equal", input);
+
+    for (auto& [name, values] : inputs) {
+        Array<int> array;
+        array.assign(values.begin(), values.end());
+
+        auto start = std::chrono::steady_clock::now();
+        ssort(array.begin(), array.end(), std::less<int>());
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        std::sort(values.begin(), values.end());
+        auto reference = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "[          ] " << name << ": ssort " << elapsed.count() << " ms, std::sort "
+                  << reference.count() << " ms" << std::endl;
+        ASSERT_TRUE(std::equal(array.begin(), array.end(), values.begin()));
+    }
+}
+
+// Test case for the adaptive sort on presorted and adversarial inputs
+TEST(Array, SortPatternTime) {
+    const int n = 1000000;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+
+    std::vector<std::pair<std::string, std::vector<int>>> inputs;
+    std::vector<int> input(n);
+    std::iota(input.begin(), input.end(), 0);
+    inputs.emplace_back("sorted", input);
+    for (int i = n - n / 100; i < n; i++) input[i] = dist(gen);
+    inputs.emplace_back("sorted + 1% appended", input);
+    std::iota(input.begin(), input.end(), 0);
+    for (int i = 0; i < 100; i++) std::swap(input[dist(gen) % n], input[dist(gen) % n]);
+    inputs.emplace_back("100 swaps", input);
+    std::iota(input.begin(), input.end(), 0);
+    std::reverse(input.begin(), input.end());
+    inputs.emplace_back("reversed", input);
+    for (int i = 0; i < n; i++) input[i] = i % 1000;
+    inputs.emplace_back("sawtooth", input);
+    for (int& value : input) value = dist(gen);
+    inputs.emplace_back("random", input);
+
+    // a lambda keeps ssort off the SIMD and radix paths
+    auto less = [](int a, int b) { return a < b; };
+    for (auto& [name, values] : inputs) {
+        Array<int> array, reference;
+        array.assign(values.begin(), values.end());
+        reference.assign(values.begin(), values.end());
+
+        auto start = std::chrono::steady_clock::now();
+        ssort(array.begin(), array.end(), less);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        introsort(reference.begin(), reference.end(), less, 40);
+        auto scalar = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "[          ] " << name << ": ssort " << elapsed.count() << " ms, introsort "
+                  << scalar.count() << " ms" << std::endl;
+        ASSERT_TRUE(std::equal(array.begin(), array.end(), reference.begin()));
+    }
+
+    Array<std::string> strings;
+    for (int i = 0; i < 10000; i++) {
+        strings.push_back(std::to_string(dist(gen) % 500));
+    }
+    ssort(strings.begin(), strings.end(), [](const std::string& a, const std::string& b) { return a < b; });
+    ASSERT_TRUE(std::is_sorted(strings.begin(), strings.end()));
+}
+
+// Test case for the stable sort with and without a buffer, and for projections
+TEST(Array, StableSortTest) {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(0, 50);
+
+    struct Record {
+        int key;
+        int order;
+        std::string name;
+    };
+    auto byKey = [](const Record& a, const Record& b) { return a.key < b.key; };
+
+    for (size_t bufferSize : { 0, 10, 100000 }) {
+        for (int n : { 0, 1, 31, 33, 1000, 20000 }) {
+            Array<Record> records;
+            for (int i = 0; i < n; i++) {
+                records.push_back({ i % 7 == 0 ? n - i : dist(gen), i, std::to_string(i) });
+            }
+            Array<Record> buffer;
+            buffer.resize(bufferSize);
+
+            stableSort(records.begin(), records.end(), byKey, buffer);
+            for (int i = 1; i < n; i++) {
+                ASSERT_TRUE(records[i - 1].key < records[i].key
+                            || (records[i - 1].key == records[i].key && records[i - 1].order < records[i].order));
+                ASSERT_EQ(records[i].name, std::to_string(records[i].order));
+            }
+        }
+    }
+
+    std::vector<int> descending(1000);
+    std::iota(descending.rbegin(), descending.rend(), 0);
+    stableSort(descending.begin(), descending.end(), std::less<int>());
+    ASSERT_TRUE(std::is_sorted(descending.begin(), descending.end()));
+
+    // the allocated buffer needs no default constructor
+    struct Keyed {
+        explicit Keyed(int key) : key(key), name(std::to_string(key)) {}
+        int key;
+        std::string name;
+    };
+    std::vector<Keyed> keyed;
+    for (int i = 0; i < 3000; i++) {
+        keyed.emplace_back(i * 7919 % 3000 / 10);
+    }
+    stableSort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b) { return a.key < b.key; });
+    for (int i = 0; i < 3000; i++) {
+        ASSERT_EQ(keyed[i].key, i / 10);
+        ASSERT_EQ(keyed[i].name, std::to_string(i / 10));
+    }
+
+    // SoAArray rows are proxies: runs, binary insertion and merges hold them as values
+    SoAArray<int, std::string> rows;
+    for (int i = 0; i < 3000; i++) {
+        rows.push_back(i * 7919 % 3000 / 10, std::to_string(i));
+    }
+    stableSort(rows.begin(), rows.end(), rows.byColumn<0>(std::less<>()));
+    for (int i = 1; i < 3000; i++) {
+        ASSERT_EQ(rows[i].get<0>(), i / 10);
+        if (rows[i - 1].get<0>() == rows[i].get<0>()) {
+            ASSERT_LT(std::stoi(rows[i - 1].get<1>()), std::stoi(rows[i].get<1>()));
+        }
+    }
+
+    // projections: by a string field, stable and unstable, and by an int field through radix sort
+    Array<Record> records;
+    for (int i = 0; i < 5000; i++) {
+        records.push_back({ dist(gen), i, std::to_string(dist(gen)) });
+    }
+    stableSort(records.begin(), records.end(), std::less<>(), [](const Record& r) { return r.name; });
+    for (size_t i = 1; i < records.size(); i++) {
+        ASSERT_LE(records[i - 1].name, records[i].name);
+        if (records[i - 1].name == records[i].name) {
+            ASSERT_LT(records[i - 1].order, records[i].order);
+        }
+    }
+    stableSort(records.begin(), records.end(), std::greater<int>(), &Record::key);
+    for (size_t i = 1; i < records.size(); i++) {
+        ASSERT_GE(records[i - 1].key, records[i].key);
+        if (records[i - 1].key == records[i].key) {
+            ASSERT_LE(records[i - 1].name, records[i].name);
+        }
+    }
+    ssort(records.begin(), records.end(), std::less<int>(), &Record::order);
+    for (size_t i = 0; i < records.size(); i++) {
+        ASSERT_EQ(records[i].order, i);
+    }
+    ssort(records.begin(), records.end(), [](const std::string& a, const std::string& b) { return a.size() < b.size(); },
+          [](const Record& r) { return r.name; });
+    ASSERT_TRUE(std::is_sorted(records.begin(), records.end(),
+                               [](const Record& a, const Record& b) { return a.name.size() < b.name.size(); }));
+}
+
+// Compares the stable sort with a full buffer, a small one and none on 1M ints
+TEST(Array, StableSortTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::vector<int> input(1000000);
+    for (int& value : input) value = dist(gen);
+
+    for (size_t bufferSize : { input.size() / 2, input.size() / 64, size_t(0) }) {
+        Array<int> array, buffer;
+        array.assign(input.begin(), input.end());
+        buffer.resize(bufferSize);
+
+        auto start = std::chrono::steady_clock::now();
+        stableSort(array.begin(), array.end(), [](int a, int b) { return a < b; }, buffer);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "[          ] buffer of " << bufferSize << ": " << elapsed.count() << " ms" << std::endl;
+        ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+    }
+}
+
+// Test case for selectNth, partialSort and TopK
+TEST(Array, SelectTest) {
+    std::mt19937 gen(5);
+
+    for (int range : { 10, 1000000 }) {
+        std::uniform_int_distribution<int> dist(0, range);
+        for (int n : { 1, 15, 100, 5000 }) {
+            Array<int> input;
+            for (int i = 0; i < n; i++) input.push_back(dist(gen));
+            Array<int> sorted(input);
+            std::sort(sorted.begin(), sorted.end());
+
+            for (int nth : { 0, n / 3, n - 1 }) {
+                for (int maxdepth : { 64, 0 }) {
+                    Array<int> array(input);
+                    // depth 0 takes the median-of-medians pivot from the start
+                    introselect(array.begin(), array.begin() + nth, array.end(), std::less<int>(), maxdepth);
+                    ASSERT_EQ(array[nth], sorted[nth]);
+                    for (int i = 0; i < n; i++) {
+                        ASSERT_TRUE(i < nth ? array[i] <= array[nth] : array[i] >= array[nth]);
+                    }
+                }
+
+                Array<int> array(input);
+                partialSort(array.begin(), array.begin() + nth + 1, array.end(), std::less<int>());
+                ASSERT_TRUE(std::equal(array.begin(), array.begin() + nth + 1, sorted.begin()));
+            }
+
+            for (size_t k : { 0, 1, 10, 10000 }) {
+                TopK<int, std::greater<int>> largest(k);
+                largest.push(input.begin(), input.end());
+                ASSERT_EQ(largest.size(), std::min<size_t>(k, n));
+                Array<int> top = largest.take();
+                ASSERT_EQ(largest.size(), 0);
+                ASSERT_TRUE(std::equal(top.begin(), top.end(), std::make_reverse_iterator(sorted.end())));
+            }
+        }
+    }
+
+    // sorted, reversed and all-equal inputs
+    Array<int> array;
+    for (int i = 0; i < 10000; i++) array.push_back(i);
+    selectNth(array.begin(), array.begin() + 1234, array.end(), std::less<int>());
+    ASSERT_EQ(array[1234], 1234);
+    selectNth(array.begin(), array.begin() + 1234, array.end(), std::greater<int>());
+    ASSERT_EQ(array[1234], 10000 - 1 - 1234);
+    array.assign(10000, 7);
+    partialSort(array.begin(), array.begin() + 100, array.end(), std::less<int>());
+    ASSERT_EQ(std::count(array.begin(), array.end(), 7), 10000);
+
+    // streaming strings, moved in
+    TopK<std::string> shortest(3, std::less<std::string>());
+    for (const char* word : { "pear", "fig", "apple", "kiwi", "date", "banana" }) {
+        shortest.push(std::string(word));
+    }
+    ASSERT_EQ(shortest.worst(), "date");
+    Array<std::string> words = shortest.take();
+    ASSERT_EQ(words.size(), 3);
+    ASSERT_EQ(words[0], "apple");
+    ASSERT_EQ(words[2], "date");
+}
+
+// Compares the top 1000 of 10M ints by full sort, partialSort and streaming TopK
+TEST(Array, SelectTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    Array<int> input;
+    for (int i = 0; i < 10000000; i++) input.push_back(dist(gen));
+    const size_t k = 1000;
+
+    Array<int> array(input);
+    auto start = std::chrono::steady_clock::now();
+    ssort(array.begin(), array.end(), std::greater<int>());
+    auto sortTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Array<int> expected;
+    expected.assign(array.begin(), array.begin() + k);
+
+    array = input;
+    start = std::chrono::steady_clock::now();
+    partialSort(array.begin(), array.begin() + k, array.end(), std::greater<int>());
+    auto partialTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), array.begin()));
+
+    start = std::chrono::steady_clock::now();
+    TopK<int, std::greater<int>> largest(k);
+    largest.push(input.begin(), input.end());
+    Array<int> top = largest.take();
+    auto topTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), top.begin()));
+
+    std::cout << "[          ] ssort: " << sortTime.count() << " ms, partialSort: " << partialTime.count()
+              << " ms, TopK: " << topTime.count() << " ms" << std::endl;
+}
+
+// Test case for heapify, heapsort and PriorityQueue with handles
+TEST(Array, HeapTest) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    for (int n : { 0, 1, 2, 3, 10, 1000, 4097 }) {
+        Array<int> array;
+        for (int i = 0; i < n; i++) array.push_back(dist(gen));
+        heapify(array.begin(), array.end(), std::less<int>());
+        ASSERT_TRUE(std::is_heap(array.begin(), array.end()));
+        heapsort(array.begin(), array.end(), std::greater<int>());
+        ASSERT_TRUE(std::is_sorted(array.begin(), array.end(), std::greater<int>()));
+    }
+
+    // rows of a SoAArray are moved through proxies
+    SoAArray<int, std::string> rows;
+    for (int i = 0; i < 1000; i++) {
+        int key = i * 7919 % 1000;
+        rows.push_back(key, std::to_string(key));
+    }
+    heapsort(rows.begin(), rows.end(), rows.byColumn<0>(std::less<>()));
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(rows[i].get<0>(), i);
+        ASSERT_EQ(rows[i].get<1>(), std::to_string(i));
+    }
+
+    // random pushes, pops, key changes and cancellations against a sorted reference
+    PriorityQueue<int> queue;
+    std::vector<std::pair<int, size_t>> reference;
+    for (int step = 0; step < 20000; step++) {
+        int action = dist(gen) % 6;
+        if (reference.empty() || action < 2) {
+            int value = dist(gen);
+            reference.push_back({ value, queue.push(value) });
+        } else if (action == 2) {
+            auto best = std::min_element(reference.begin(), reference.end());
+            ASSERT_EQ(queue.top(), best->first);
+            // equal values may sit under any of their handles
+            ASSERT_EQ(queue.get(queue.topHandle()), best->first);
+            auto top = std::find_if(reference.begin(), reference.end(),
+                                    [&](const auto& entry) { return entry.second == queue.topHandle(); });
+            reference.erase(top);
+            queue.pop();
+        } else {
+            auto& entry = reference[dist(gen) % reference.size()];
+            ASSERT_TRUE(queue.contains(entry.second));
+            ASSERT_EQ(queue.get(entry.second), entry.first);
+            if (action == 3) {
+                entry.first -= dist(gen) % 50;
+                queue.decreaseKey(entry.second, entry.first);
+            } else if (action == 4) {
+                entry.first = dist(gen);
+                queue.update(entry.second, entry.first);
+            } else {
+                queue.erase(entry.second);
+                ASSERT_FALSE(queue.contains(entry.second));
+                reference.erase(reference.begin() + (&entry - reference.data()));
+            }
+        }
+        ASSERT_EQ(queue.size(), reference.size());
+    }
+    for (std::sort(reference.begin(), reference.end()); !queue.empty(); queue.pop()) {
+        ASSERT_EQ(queue.top(), reference.front().first);
+        reference.erase(reference.begin());
+    }
+    ASSERT_THROW(queue.pop(), std::out_of_range);
+
+    // largest first, constructed in place
+    PriorityQueue<std::string, std::greater<std::string>> words;
+    for (const char* word : { "pear", "fig", "apple" }) {
+        words.emplace(word);
+    }
+    ASSERT_EQ(words.top(), "pear");
+}
+
+// Compares heapsort with std::make_heap and std::sort_heap on 1M ints
+TEST(Array, HeapsortTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::vector<int> input(1000000);
+    for (int& value : input) value = dist(gen);
+
+    std::vector<int> array(input);
+    auto start = std::chrono::steady_clock::now();
+    heapsort(array.begin(), array.end(), std::less<int>());
+    auto heapsortTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+
+    array = input;
+    start = std::chrono::steady_clock::now();
+    std::make_heap(array.begin(), array.end());
+    std::sort_heap(array.begin(), array.end());
+    auto stdTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "[          ] heapsort: " << heapsortTime.count() << " ms, std::sort_heap: " << stdTime.count() << " ms" << std::endl;
+}
+
+// Test case for the string sort and the ssort dispatch to it
+TEST(Array, StringSortTest) {
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<int> length(0, 12);
+    std::uniform_int_distribution<int> letter(0, 3);
+
+    for (int n : { 0, 1, 15, 31, 32, 1000, 30000 }) {
+        // few letters and shared prefixes: many duplicates, many strings that are prefixes of
+        // others, bytes above 127 and embedded zeros
+        Array<std::string> array;
+        for (int i = 0; i < n; i++) {
+            std::string value = i % 3 == 0 ? "https://example.com/" : "";
+            for (int j = length(gen); j > 0; j--) {
+                value += char(i % 5 == 0 ? 0xe0 + letter(gen) : i % 7 == 0 ? letter(gen) : 'a' + letter(gen));
+            }
+            array.push_back(value);
+        }
+        std::vector<std::string> expected(array.begin(), array.end());
+
+        std::sort(expected.begin(), expected.end());
+        ssort(array.begin(), array.end(), std::less<std::string>());
+        ASSERT_TRUE(std::equal(array.begin(), array.end(), expected.begin()));
+
+        std::sort(expected.begin(), expected.end(), std::greater<>());
+        stringSort(array.begin(), array.end(), std::greater<>());
+        ASSERT_TRUE(std::equal(array.begin(), array.end(), expected.begin()));
+    }
+
+    std::vector<std::string> words(5000, "same");
+    words.push_back("");
+    ssort(words.begin(), words.end(), std::less<>());
+    ASSERT_EQ(words[0], "");
+    ASSERT_EQ(words.back(), "same");
+
+    std::vector<std::string_view> views{ "pear", "fig", "apple", "figs", "" };
+    stringSort(views.begin(), views.end(), std::less<std::string_view>());
+    ASSERT_TRUE(std::is_sorted(views.begin(), views.end()));
+
+    // projection on a string field
+    struct Page {
+        std::string url;
+        int id;
+    };
+    Array<Page> pages;
+    for (int i = 0; i < 2000; i++) {
+        pages.push_back({ "https://example.com/" + std::to_string(i * 7919 % 2000), i });
+    }
+    ssort(pages.begin(), pages.end(), std::greater<>(), &Page::url);
+    for (size_t i = 1; i < pages.size(); i++) {
+        ASSERT_GE(pages[i - 1].url, pages[i].url);
+    }
+}
+
+// Compares the string sort with pdqsort and std::sort on 1M URL-like strings
+TEST(Array, StringSortTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> host(0, 999);
+    std::uniform_int_distribution<int> path(0, 1 << 30);
+    std::vector<std::string> input;
+    for (int i = 0; i < 1000000; i++) {
+        input.push_back("https://www.host" + std::to_string(host(gen)) + ".com/page/" + std::to_string(path(gen)));
+    }
+
+    std::vector<std::string> array(input);
+    auto start = std::chrono::steady_clock::now();
+    ssort(array.begin(), array.end(), std::less<std::string>());
+    auto stringTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+
+    array = input;
+    start = std::chrono::steady_clock::now();
+    pdqsort(array.begin(), array.end(), std::less<std::string>(), 20, true);
+    auto pdqTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    array = input;
+    start = std::chrono::steady_clock::now();
+    std::sort(array.begin(), array.end());
+    auto stdTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "[          ] stringSort: " << stringTime.count() << " ms, pdqsort: " << pdqTime.count()
+              << " ms, std::sort: " << stdTime.count() << " ms" << std::endl;
+}
+
+// Test case for argsort and applying one permutation to several ranges
+TEST(Array, ArgsortTest) {
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> dist(0, 500);
+
+    struct Record {
+        int key;
+        std::string name;
+        double payload[8];
+    };
+    auto byKey = [](const Record& a, const Record& b) { return a.key < b.key; };
+
+    for (int n : { 0, 1, 100, 5000 }) {
+        Array<Record> records;
+        Array<int> ids;
+        std::vector<std::string> names;
+        for (int i = 0; i < n; i++) {
+            records.push_back({ dist(gen), std::to_string(dist(gen)), { double(i) } });
+            ids.push_back(i);
+            names.push_back(records[i].name);
+        }
+
+        Array<size_t> order = argsort(records.begin(), records.end(), byKey);
+        ASSERT_EQ(order.size(), n);
+        for (int i = 1; i < n; i++) {
+            ASSERT_LE(records[order[i - 1]].key, records[order[i]].key);
+        }
+
+        // packed keys: radix sorted ints, string sorted names, compared doubles
+        Array<size_t> byName = argsort(records.begin(), records.end(), std::less<>(), &Record::name);
+        for (int i = 1; i < n; i++) {
+            ASSERT_LE(records[byName[i - 1]].name, records[byName[i]].name);
+        }
+        Array<size_t> byPayload = argsort(records.begin(), records.end(), std::greater<>(),
+                                          [](const Record& r) { return r.payload[0]; });
+        for (int i = 0; i < n; i++) {
+            ASSERT_EQ(byPayload[i], n - 1 - i);
+        }
+
+        order = argsort(records.begin(), records.end(), std::less<int>(), &Record::key);
+        applyPermutation(order, records.begin(), ids.begin(), names.begin());
+        for (int i = 0; i < n; i++) {
+            ASSERT_EQ(ids[i], order[i]);
+            ASSERT_EQ(records[i].payload[0], order[i]);
+            ASSERT_EQ(names[i], records[i].name);
+            if (i > 0) {
+                ASSERT_LE(records[i - 1].key, records[i].key);
+            }
+        }
+    }
+
+    // columns of a SoAArray reordered through their spans and through its proxy iterator
+    SoAArray<int, double> columns;
+    for (int i = 0; i < 1000; i++) {
+        columns.push_back(dist(gen), i * 0.5);
+    }
+    auto keys = columns.column<0>();
+    Array<size_t> order = argsort(keys.begin(), keys.end(), std::less<int>());
+    Array<size_t> original(order);
+    applyPermutation(order, keys.begin(), columns.column<1>().begin());
+    ASSERT_TRUE(std::equal(order.begin(), order.end(), original.begin()));
+    for (size_t i = 0; i < columns.size(); i++) {
+        ASSERT_EQ(columns.column<1>()[i], original[i] * 0.5);
+        if (i > 0) {
+            ASSERT_LE(keys[i - 1], keys[i]);
+        }
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = order.size() - 1 - i;
+    }
+    applyPermutation(order, columns.begin());
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end(), std::greater<int>()));
+}
+
+// Compares ssort of 250k 512-byte records with argsort by key and one applyPermutation
+TEST(Array, ArgsortTime) {
+    struct Record {
+        int key;
+        char payload[508];
+    };
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::vector<Record> input(250000);
+    for (Record& record : input) record.key = dist(gen);
+    auto byKey = [](const Record& a, const Record& b) { return a.key < b.key; };
+
+    std::vector<Record> records(input);
+    auto start = std::chrono::steady_clock::now();
+    ssort(records.begin(), records.end(), byKey);
+    auto sortTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    records = input;
+    start = std::chrono::steady_clock::now();
+    Array<size_t> order = argsort(records.begin(), records.end(), byKey);
+    applyPermutation(order, records.begin());
+    auto indirectTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(std::is_sorted(records.begin(), records.end(), byKey));
+
+    records = input;
+    start = std::chrono::steady_clock::now();
+    order = argsort(records.begin(), records.end(), std::less<int>(), &Record::key);
+    applyPermutation(order, records.begin());
+    auto packedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(std::is_sorted(records.begin(), records.end(), byKey));
+
+    std::cout << "[          ] ssort: " << sortTime.count() << " ms, argsort: " << indirectTime.count()
+              << " ms, argsort on packed keys: " << packedTime.count() << " ms" << std::endl;
+}
+
+// Test case for the parallel ssort on Array and std::vector
+TEST(Array, ParallelSortTest) {
+    ThreadPool pool(4);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    Array<int> array;
+    std::vector<int> values;
+    for (int i = 0; i < 500000; i++) {
+        int n = dist(gen);
+        array.push_back(n);
+        values.push_back(-n);
+    }
+    ssort(pool, array.begin(), array.end(), std::less<int>());
+    ssort(pool, values.begin(), values.end(), std::greater<int>());
+    ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end(), std::greater<int>()));
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(array[i], -values[i]);
+    }
+
+    std::iota(values.begin(), values.end(), 0);
+    std::reverse(values.begin(), values.end());
+    ssort(pool, values.begin(), values.end(), std::less<int>());
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+
+    // leaves go through the sequential ssort and its string sort
+    std::vector<std::string> strings;
+    for (int i = 0; i < 100000; i++) {
+        strings.push_back("key" + std::to_string(dist(gen) * 7919));
+    }
+    std::vector<std::string> expected(strings);
+    std::sort(expected.begin(), expected.end());
+    ssort(pool, strings.begin(), strings.end(), std::less<>());
+    ASSERT_EQ(strings, expected);
+
+    TaskGroup group;
+    pool.run(group, [] { throw std::runtime_error("task failed"); });
+    ASSERT_THROW(pool.wait(group), std::runtime_error);
+}
+
+// Test case for the parallel ssort scaling with the number of threads
+TEST(Array, ParallelSortTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::vector<int> input(10000000);
+    for (int& value : input) value = dist(gen);
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+        ThreadPool pool(threads);
+        Array<int> array;
+        array.assign(input.begin(), input.end());
+
+        auto start = std::chrono::steady_clock::now();
+        ssort(pool, array.begin(), array.end(), std::less<int>());
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "[          ] " << threads << " threads: " << elapsed.count() << " ms" << std::endl;
+        ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+    }
+}
+
+// Test case for the SIMD sorting kernels on every instruction set of this CPU
+TEST(Array, SimdSortTest) {
+    std::mt19937 gen(11);
+
+    auto check = [&](auto key) {
+        using T = decltype(key);
+        std::uniform_int_distribution<int> dist(-100000, 100000);
+        std::uniform_int_distribution<int> few(-3, 3);
+
+        for (int level = (int)SimdLevel::Avx2; level <= (int)simdLevel(); level++) {
+            for (size_t n : { 0, 1, 7, 31, 64, 65, 200, 1000, 100000 }) {
+                for (bool duplicates : { false, true }) {
+                    std::vector<T> values(n);
+                    for (T& value : values) value = T(duplicates ? few(gen) : dist(gen)) / 2;
+                    Array<T> array;
+                    array.assign(values.begin(), values.end());
+
+                    ASSERT_TRUE(simdSort(array.data(), array.data() + n, (SimdLevel)level));
+                    std::sort(values.begin(), values.end());
+                    ASSERT_TRUE(std::equal(array.begin(), array.end(), values.begin())) << n;
+                }
+            }
+        }
+    };
+    check(int32_t());
+    check(int64_t());
+    check(float());
+    check(double());
+
+    // signed zeros and NaNs: the result is a permutation, NaNs last and the rest in order
+    auto checkSpecial = [&](auto key) {
+        using T = decltype(key);
+        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        const T specials[] = { T(0), -T(0), T(1), -T(1), std::numeric_limits<T>::infinity(),
+                               std::numeric_limits<T>::quiet_NaN(), -std::numeric_limits<T>::quiet_NaN() };
+        std::uniform_int_distribution<int> pick(0, 6);
+
+        for (int level = (int)SimdLevel::Avx2; level <= (int)simdLevel(); level++) {
+            for (size_t n : { 2, 4, 63, 100, 255, 1000, 20000 }) {
+                for (int nanChance : { 0, 1 }) {
+                    std::vector<T> values(n);
+                    for (T& value : values) {
+                        int i = pick(gen);
+                        value = specials[nanChance == 0 && i >= 5 ? i - 5 : i];
+                    }
+                    Array<T> array;
+                    array.assign(values.begin(), values.end());
+
+                    ASSERT_TRUE(simdSort(array.data(), array.data() + n, (SimdLevel)level));
+                    auto bits = [](auto& range) {
+                        std::vector<Bits> result;
+                        for (T value : range) result.push_back(std::bit_cast<Bits>(value));
+                        std::sort(result.begin(), result.end());
+                        return result;
+                    };
+                    ASSERT_EQ(bits(array), bits(values)) << n;
+                    auto numbers = std::partition_point(array.begin(), array.end(), [](T x) { return x == x; });
+                    ASSERT_TRUE(std::is_sorted(array.begin(), numbers)) << n;
+                    ASSERT_TRUE(std::all_of(numbers, array.end(), [](T x) { return x != x; })) << n;
+                }
+            }
+        }
+    };
+    checkSpecial(float());
+    checkSpecial(double());
+
+    Array<int> array{ 3, 1, 2 };
+    ASSERT_FALSE(simdSort(array.data(), array.data() + 3, SimdLevel::Scalar));
+    ASSERT_EQ(array[0], 3);
+
+    Array<double> extremes{ 1.5, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::max(), -0.5 };
+    ssort(extremes.begin(), extremes.end(), std::less<double>());
+    ASSERT_TRUE(std::is_sorted(extremes.begin(), extremes.end()));
+}
+
+// Compares the SIMD kernels with the scalar introsort on 1M ints and doubles
+TEST(Array, SimdSortTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    auto time = [&](auto key) {
+        using T = decltype(key);
+        Array<T> array, reference;
+        for (int i = 0; i < 1000000; i++) {
+            array.push_back(T(dist(gen)) / 3);
+        }
+        reference = array;
+
+        auto start = std::chrono::steady_clock::now();
+        ssort(array.begin(), array.end(), std::less<T>());
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        introsort(reference.begin(), reference.end(), std::less<T>(), 40);
+        auto scalar = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "[          ] " << sizeof(T) << "-byte " << (std::is_integral_v<T> ? "int" : "float") << ": simd "
+                  << elapsed.count() << " ms, introsort " << scalar.count() << " ms" << std::endl;
+        ASSERT_TRUE(std::equal(array.begin(), array.end(), reference.begin()));
+    };
+    time(int());
+    time(double());
+}
+
+// Test case for LSD and MSD radix sorts and the ssort dispatch to them
+TEST(Array, RadixSortTest) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> dist(-1000000, 1000000);
+
+    auto check = [&](auto key, size_t n) {
+        using T = decltype(key);
+        std::vector<T> values(n);
+        for (T& value : values) value = T(dist(gen)) / 8;
+        Array<T> lsd, msd;
+        lsd.assign(values.begin(), values.end());
+        msd.assign(values.begin(), values.end());
+
+        radixSort(lsd.begin(), lsd.end(), [](T x) { return x; });
+        msdRadixSort(msd.begin(), msd.end(), [](T x) { return x; });
+        std::sort(values.begin(), values.end());
+        ASSERT_TRUE(std::equal(lsd.begin(), lsd.end(), values.begin()));
+        ASSERT_TRUE(std::equal(msd.begin(), msd.end(), values.begin()));
+    };
+    for (size_t n : { 0, 1, 100, 5000, 100000 }) {
+        check(int(), n);
+        check(int8_t(), n);
+        check(uint16_t(), n);
+        check(int64_t(), n);
+        check(float(), n);
+        check(double(), n);
+    }
+
+    // the cycles of the MSD sort carry SoAArray rows as values, not as proxies
+    SoAArray<int, std::string> rows;
+    for (int i = 0; i < 5000; i++) {
+        int key = i * 7919 % 5000;
+        rows.push_back(key, std::to_string(key));
+    }
+    msdRadixSort(rows.begin(), rows.end(), [](const auto& row) { return std::get<0>(std::tuple<int, std::string>(row)); });
+    for (int i = 0; i < 5000; i++) {
+        ASSERT_EQ(rows[i].get<0>(), i);
+        ASSERT_EQ(rows[i].get<1>(), std::to_string(i));
+    }
+
+    Array<double> zeros{ 0.0, -0.0, 1.0, -std::numeric_limits<double>::infinity(), -1.0 };
+    radixSort(zeros.begin(), zeros.end(), [](double x) { return x; });
+    ASSERT_TRUE(std::signbit(zeros[2]) && !std::signbit(zeros[3]));
+    ASSERT_EQ(zeros[0], -std::numeric_limits<double>::infinity());
+
+    // records by key, equal keys keep their order
+    Array<std::pair<int, int>> records, scratch;
+    for (int i = 0; i < 10000; i++) {
+        records.push_back({ dist(gen) % 100, i });
+    }
+    radixSort(records.begin(), records.end(), [](const std::pair<int, int>& r) { return r.first; }, scratch);
+    ASSERT_TRUE(std::is_sorted(records.begin(), records.end()));
+    const std::pair<int, int>* buffer = scratch.data();
+    radixSort(records.begin(), records.end(), [](const std::pair<int, int>& r) { return -r.second; }, scratch);
+    ASSERT_EQ(scratch.data(), buffer);
+    ASSERT_EQ(records[0].second, 9999);
+
+    std::vector<int> descending(50000);
+    for (int& value : descending) value = dist(gen);
+    ssort(descending.begin(), descending.end(), std::greater<int>());
+    ASSERT_TRUE(std::is_sorted(descending.begin(), descending.end(), std::greater<int>()));
+}
+
+// Compares radix sorts with the scalar introsort on 1M random ints
+TEST(Array, RadixSortTime) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::vector<int> input(1000000);
+    for (int& value : input) value = dist(gen);
+
+    Array<int> scratch;
+    auto time = [&](const char* name, auto sort) {
+        Array<int> array;
+        array.assign(input.begin(), input.end());
+
+        auto start = std::chrono::steady_clock::now();
+        sort(array);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "[          ] " << name << ": " << elapsed.count() << " ms" << std::endl;
+        ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+    };
+    time("introsort", [](Array<int>& a) { introsort(a.begin(), a.end(), std::less<int>(), 40); });
+    time("lsd radix", [&](Array<int>& a) { radixSort(a.begin(), a.end(), [](int x) { return x; }, scratch); });
+    time("lsd radix, warm scratch", [&](Array<int>& a) { radixSort(a.begin(), a.end(), [](int x) { return x; }, scratch); });
+    time("msd radix", [](Array<int>& a) { msdRadixSort(a.begin(), a.end(), [](int x) { return x; }); });
+}
+
 TEST(Array, Arrtime) {
     Array<int> array;
 
@@ -218,6 +1174,509 @@ TEST(Array, Vectime) {
     }
 }
 
+// Test case for SmallArray inline storage
+TEST(Array, SmallArrayTest) {
+    SmallArray<int, 4> array{4, 3, 2};
+    const int* inlineData = array.data();
+    ASSERT_EQ(array.capacity(), 4);
+
+    array.push_back(1);
+    ASSERT_EQ(array.data(), inlineData);
+
+    for (int i = 0; i < 16; i++) {
+        array.push_back(i);
+    }
+    ASSERT_NE(array.data(), inlineData);
+    ssort(array.begin(), array.end(), [](int a, int b) { return a < b; });
+    ASSERT_TRUE(std::is_sorted(array.begin(), array.end()));
+
+    SmallArray<std::string, 2> strings{ "sort", "array" };
+    SmallArray<std::string, 2> strings2(std::move(strings));
+    ASSERT_EQ(strings.size(), 0);
+    ASSERT_EQ(strings2[0], "sort");
+    ASSERT_EQ(strings2[1], "array");
+
+    strings2.push_back("string");
+    SmallArray<std::string, 2> strings3;
+    strings3 = strings2;
+    strings = std::move(strings2);
+    ASSERT_EQ(strings3.size(), 3);
+    ASSERT_EQ(strings[2], "string");
+}
+
+// Test case for Array class with arena and pmr allocators
+TEST(Array, ArenaTest) {
+    Arena arena(1024);
+    {
+        Array<int, DoublingGrowth, ArenaAllocator<int>> array{ArenaAllocator<int>(&arena)};
+        for (int i = 0; i < 100; i++) {
+            array.push_back(i);
+        }
+        Array<int, DoublingGrowth, ArenaAllocator<int>> array2(array);
+
+        ASSERT_EQ(array2.get_allocator(), array.get_allocator());
+        for (int i = 0; i < 100; i++) {
+            ASSERT_EQ(array2[i], i);
+        }
+
+        PmrArray<std::pmr::string> strings{&arena};
+        strings.emplace_back("a string long enough to skip the small string buffer");
+        ASSERT_EQ(strings[0].get_allocator().resource(), &arena);
+    }
+    ASSERT_NE(arena.used(), 0);
+    arena.release();
+    ASSERT_EQ(arena.used(), 0);
+    ASSERT_EQ(arena.blockCount(), 1);
+}
+
+TEST(Array, ArenaBatchTime) {
+    Arena arena;
+
+    for (int batch = 0; batch < 100; batch++) {
+        for (int i = 0; i < 1000; i++) {
+            Array<int, DoublingGrowth, ArenaAllocator<int>> array{ArenaAllocator<int>(&arena)};
+            for (int j = 0; j < 20; j++) {
+                array.push_back(j);
+            }
+        }
+        arena.release();
+    }
+}
+
+TEST(Array, HeapBatchTime) {
+    for (int batch = 0; batch < 100; batch++) {
+        for (int i = 0; i < 1000; i++) {
+            Array<int> array;
+            for (int j = 0; j < 20; j++) {
+                array.push_back(j);
+            }
+        }
+    }
+}
+
+// Test case for Array class with aligned and huge page backed storage
+TEST(Array, AlignedArrayTest) {
+    AlignedArray<float> array;
+    for (int i = 0; i < 100; i++) {
+        array.push_back(i);
+    }
+    ASSERT_EQ((uintptr_t)array.data() % 64, 0);
+    ASSERT_EQ(array.capacity() * sizeof(float) % 64, 0);
+
+    using HugeAllocator = AlignedAllocator<double, 64, true>;
+    Array<double, DoublingGrowth, HugeAllocator> large;
+    large.resize(1 << 20);
+    ASSERT_EQ((uintptr_t)large.data() % HugeAllocator::hugePageSize, 0);
+    ASSERT_GE(large.capacity(), large.size());
+}
+
+// Test case for SoAArray sorting by a key column
+TEST(Array, SoAArrayTest) {
+    SoAArray<int, double, std::string> records;
+    std::vector<std::tuple<int, double, std::string>> std_vector;
+
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    for (int i = 0; i < 1000; i++) {
+        int key = dist(gen);
+        records.push_back(key, key * 0.5, std::to_string(key));
+        std_vector.emplace_back(key, key * 0.5, std::to_string(key));
+    }
+
+    ssort(records.begin(), records.end(), records.byColumn<0>([](int a, int b) { return a < b; }));
+    std::sort(std_vector.begin(), std_vector.end());
+
+    auto keys = records.column<0>();
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    for (size_t i = 0; i < records.size(); ++i) {
+        ASSERT_EQ(records[i].get<0>(), std::get<0>(std_vector[i]));
+        ASSERT_EQ(records[i].get<1>(), std::get<1>(std_vector[i]));
+        ASSERT_EQ(records[i].get<2>(), std::get<2>(std_vector[i]));
+    }
+
+    auto values = records.column<1>();
+    double sum = std::accumulate(values.begin(), values.end(), 0.0);
+    ASSERT_EQ(sum, std::accumulate(keys.begin(), keys.end(), 0) * 0.5);
+
+    // nearly sorted rows take the insertion sort paths, which move rows through proxies
+    SoAArray<int, std::string> rows;
+    for (int i = 0; i < 1000; i++) {
+        rows.push_back(i, std::to_string(i));
+    }
+    for (int i = 50; i < 1000; i += 100) {
+        std::swap(rows.column<0>()[i], rows.column<0>()[i + 3]);
+        std::swap(rows.column<1>()[i], rows.column<1>()[i + 3]);
+    }
+    ssort(rows.begin(), rows.end(), rows.byColumn<0>(std::less<>()));
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(rows[i].get<0>(), i);
+        ASSERT_EQ(rows[i].get<1>(), std::to_string(i));
+    }
+}
+
+// Test case for SegmentedArray stable references and sorting
+TEST(Array, SegmentedArrayTest) {
+    SegmentedArray<int, 16> array;
+    std::vector<int> std_vector;
+
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    array.push_back(-1);
+    int* first = &array[0];
+    for (int i = 0; i < 1000; i++) {
+        int n = dist(gen);
+        array.push_back(n);
+        std_vector.push_back(n);
+    }
+    ASSERT_EQ(first, &array[0]);
+
+    array.push_back(array[0]);
+    std_vector.push_back(-1);
+    std_vector.push_back(-1);
+
+    ssort(array.begin(), array.end(), [](int a, int b) { return a < b; });
+    std::sort(std_vector.begin(), std_vector.end());
+
+    ASSERT_EQ(array.size(), std_vector.size());
+    ASSERT_TRUE(std::equal(array.cbegin(), array.cend(), std_vector.begin()));
+}
+
+// Compares the slowest single push_back of Array and SegmentedArray
+TEST(Array, SegmentedAppendLatency) {
+    auto worst = [](auto& array) {
+        std::chrono::nanoseconds worst(0);
+        for (int i = 0; i < 10000000; i++) {
+            auto start = std::chrono::steady_clock::now();
+            array.push_back(i);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed > worst) worst = elapsed;
+        }
+        return worst;
+    };
+
+    Array<int> array;
+    SegmentedArray<int> segmented;
+    auto arrayWorst = worst(array);
+    auto segmentedWorst = worst(segmented);
+
+    std::cout << "[          ] worst push_back: Array " << arrayWorst.count() << " ns, SegmentedArray "
+              << segmentedWorst.count() << " ns" << std::endl;
+}
+
+// Test case for ConcurrentArray with several producers
+TEST(Array, ConcurrentArrayTest) {
+    ConcurrentArray<int, 16> array;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&array, t]() {
+            for (int i = 0; i < 10000; i++) {
+                array.push_back(t * 10000 + i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Array<int> frozen = array.freeze();
+    ASSERT_EQ(array.size(), 0);
+    ASSERT_EQ(frozen.size(), 40000);
+
+    ssort(frozen.begin(), frozen.end(), [](int a, int b) { return a < b; });
+    for (int i = 0; i < 40000; i++) {
+        ASSERT_EQ(frozen[i], i);
+    }
+
+    // segments are moved out whole, the last one only up to the size
+    ConcurrentArray<std::string, 16> strings;
+    for (int i = 0; i < 100; i++) {
+        strings.push_back(std::to_string(i));
+    }
+    Array<std::string> frozenStrings = strings.freeze();
+    ASSERT_EQ(frozenStrings.size(), 100);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(frozenStrings[i], std::to_string(i));
+    }
+}
+
+TEST(Array, ConcurrentAppendTime) {
+    const int threadCount = std::max(2u, std::thread::hardware_concurrency());
+    ConcurrentArray<int> array;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&array]() {
+            for (int i = 0; i < 1000000; i++) {
+                array.push_back(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+TEST(Array, MutexAppendTime) {
+    const int threadCount = std::max(2u, std::thread::hardware_concurrency());
+    Array<int> array;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&array, &mutex]() {
+            for (int i = 0; i < 1000000; i++) {
+                std::lock_guard<std::mutex> lock(mutex);
+                array.push_back(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Test case for CowArray snapshots
+TEST(Array, CowArrayTest) {
+    CowArray<std::string> array{ "sort", "string", "array" };
+    CowArray<std::string> snapshot(array);
+
+    ASSERT_TRUE(array.shared());
+    ASSERT_EQ(array.data(), snapshot.data());
+
+    array[1] = "cow";
+    ASSERT_FALSE(array.shared());
+    ASSERT_NE(array.data(), snapshot.data());
+    ASSERT_EQ(snapshot[1], "string");
+    ASSERT_EQ(array[1], "cow");
+
+    CowArray<std::string> snapshot2 = snapshot;
+    ssort(snapshot2.begin(), snapshot2.end(), [](const std::string& a, const std::string& b) { return a < b; });
+    ASSERT_EQ(snapshot2[0], "array");
+    ASSERT_EQ(snapshot[0], "sort");
+
+    // a reference or iterator handed out earlier must not write into a later snapshot
+    CowArray<std::string> original{ "a", "b" };
+    std::string& first = original[0];
+    auto it = original.begin() + 1;
+    CowArray<std::string> later(original);
+    ASSERT_FALSE(later.shared());
+    first = "x";
+    *it = "y";
+    ASSERT_EQ(std::as_const(later)[0], "a");
+    ASSERT_EQ(std::as_const(later)[1], "b");
+    ASSERT_EQ(std::as_const(original)[0], "x");
+
+    original.clear();
+    original.push_back("c");
+    CowArray<std::string> shared(original);
+    ASSERT_TRUE(shared.shared());
+}
+
+// Test case for MappedArray persistence and read-only sharing
+TEST(Array, MappedArrayTest) {
+    std::string path = (std::filesystem::temp_directory_path() / "mapped_array_test.bin").string();
+    std::filesystem::remove(path);
+
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    {
+        MappedArray<int> array(path);
+        for (int i = 0; i < 10000; i++) {
+            array.push_back(dist(gen));
+        }
+        ssort(array.begin(), array.end(), [](int a, int b) { return a < b; });
+        array.flush();
+    }
+    {
+        MappedArray<int> reader1(path, MappedArray<int>::Mode::ReadOnly);
+        MappedArray<int> reader2(path, MappedArray<int>::Mode::ReadOnly);
+
+        ASSERT_EQ(reader1.size(), 10000);
+        ASSERT_TRUE(std::is_sorted(reader1.cbegin(), reader1.cend()));
+        ASSERT_TRUE(std::equal(reader1.cbegin(), reader1.cend(), reader2.cbegin()));
+        ASSERT_EQ(std::as_const(reader1)[9999], reader1.cend()[-1]);
+        ASSERT_THROW(reader1.push_back(1), std::logic_error);
+        ASSERT_THROW(reader1.append(reader2.cbegin(), reader2.cend()), std::logic_error);
+        ASSERT_THROW(reader1[0] = 1, std::logic_error);
+        ASSERT_THROW(reader1.begin(), std::logic_error);
+        ASSERT_EQ(reader1.size(), 10000);
+        ASSERT_THROW(MappedArray<double> wrongType(path), std::runtime_error);
+    }
+    std::filesystem::remove(path);
+}
+
+// Test case for binary save/load and streaming reads
+TEST(Array, ArrayIOTest) {
+    std::string path = (std::filesystem::temp_directory_path() / "array_io_test.bin").string();
+
+    Array<int> array;
+    for (int i = 0; i < 100000; i++) {
+        array.push_back(i * 7);
+    }
+    saveArray(path, array);
+
+    Array<int> loaded;
+    loadArray(path, loaded);
+    ASSERT_EQ(loaded.size(), array.size());
+    ASSERT_TRUE(std::equal(loaded.begin(), loaded.end(), array.begin()));
+
+    ArrayReader<int> reader(path);
+    Array<int> chunk;
+    size_t total = 0;
+    while (size_t count = reader.read(chunk, 999)) {
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(chunk[i], array[total + i]);
+        }
+        total += count;
+    }
+    ASSERT_EQ(total, array.size());
+
+    Array<double> wrongType;
+    ASSERT_THROW(loadArray(path, wrongType), std::runtime_error);
+
+    // flip one payload byte
+    int fd = ::open(path.c_str(), O_WRONLY);
+    char byte = 1;
+    pwrite(fd, &byte, 1, sizeof(ArrayFileHeader) + 10);
+    ASSERT_THROW(loadArray(path, loaded), std::runtime_error);
+    ASSERT_EQ(loaded.size(), 0);
+
+    // a corrupt count is rejected before anything is allocated, a truncated payload after
+    uint64_t count = uint64_t(1) << 60;
+    pwrite(fd, &count, sizeof(count), offsetof(ArrayFileHeader, count));
+    ASSERT_THROW(loadArray(path, loaded), std::runtime_error);
+    ASSERT_EQ(loaded.size(), 0);
+    count = array.size();
+    pwrite(fd, &count, sizeof(count), offsetof(ArrayFileHeader, count));
+    ASSERT_EQ(ftruncate(fd, sizeof(ArrayFileHeader) + 100), 0);
+    ASSERT_THROW(loadArray(path, loaded), std::runtime_error);
+    ASSERT_EQ(loaded.size(), 0);
+    ::close(fd);
+
+    std::filesystem::remove(path);
+}
+
+// Test case for the external sort with one merge pass, several passes and a thread pool
+TEST(Array, ExternalSortTest) {
+    std::string input = (std::filesystem::temp_directory_path() / "external_sort_in.bin").string();
+    std::string output = (std::filesystem::temp_directory_path() / "external_sort_out.bin").string();
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<int> dist(0, 1 << 20);
+
+    Array<int> array;
+    for (int i = 0; i < 300000; i++) {
+        array.push_back(dist(gen));
+    }
+    saveArray(input, array);
+    Array<int> expected(array);
+    std::sort(expected.begin(), expected.end());
+
+    ThreadPool pool(4);
+    ExternalSortOptions options;
+    // 12 runs merged at once; 47 runs merged three at a time; one chunk sorted in memory
+    for (size_t budget : { size_t(1) << 20, size_t(1) << 18, size_t(1) << 24 }) {
+        options.memoryBudget = budget;
+        options.pool = budget == (1 << 18) ? &pool : nullptr;
+        externalSort<int>(input, output, std::less<int>(), options);
+
+        Array<int> sorted;
+        loadArray(output, sorted);
+        ASSERT_EQ(sorted.size(), expected.size());
+        ASSERT_TRUE(std::equal(sorted.begin(), sorted.end(), expected.begin()));
+    }
+
+    // records by a field, descending, sorted in place
+    struct Record {
+        int key;
+        double value;
+    };
+    Array<Record> records;
+    for (int i = 0; i < 50000; i++) {
+        records.push_back({ dist(gen) % 100, double(i) });
+    }
+    saveArray(input, records);
+    options.memoryBudget = 1 << 18;
+    options.pool = nullptr;
+    externalSort<Record>(input, input, [](const Record& a, const Record& b) { return a.key > b.key; }, options);
+    Array<Record> sorted;
+    loadArray(input, sorted);
+    ASSERT_EQ(sorted.size(), records.size());
+    for (size_t i = 1; i < sorted.size(); i++) {
+        ASSERT_GE(sorted[i - 1].key, sorted[i].key);
+    }
+
+    // a comparator that throws in the last merge leaves an input sorted in place untouched
+    saveArray(input, array);
+    options.memoryBudget = 1 << 20;
+    size_t comparisons = 0, limit = 0;
+    auto counting = [&](int a, int b) {
+        if (++comparisons == limit) throw std::runtime_error("comparator failed");
+        return a < b;
+    };
+    externalSort<int>(input, output, counting, options);
+    limit = comparisons - 100;
+    comparisons = 0;
+    ASSERT_THROW(externalSort<int>(input, input, counting, options), std::runtime_error);
+    Array<int> unchanged;
+    loadArray(input, unchanged);
+    ASSERT_TRUE(std::equal(unchanged.begin(), unchanged.end(), array.begin(), array.end()));
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(input).parent_path())) {
+        ASSERT_NE(entry.path().filename().string().rfind("external_sort_in.bin.", 0), 0);
+    }
+
+    saveArray(input, Array<int>());
+    externalSort<int>(input, output);
+    loadArray(output, array);
+    ASSERT_EQ(array.size(), 0);
+
+    options.tempDir = "/nonexistent";
+    saveArray(input, expected);
+    ASSERT_THROW(externalSort<int>(input, output, std::less<int>(), options), std::system_error);
+
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
+
+// Compares the external sort of 20M ints in 16 MiB with loading and sorting them in memory
+TEST(Array, ExternalSortTime) {
+    std::string input = (std::filesystem::temp_directory_path() / "external_sort_in.bin").string();
+    std::string output = (std::filesystem::temp_directory_path() / "external_sort_out.bin").string();
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    Array<int> array;
+    for (int i = 0; i < 20000000; i++) {
+        array.push_back(dist(gen));
+    }
+    saveArray(input, array);
+
+    auto start = std::chrono::steady_clock::now();
+    loadArray(input, array);
+    ssort(array.begin(), array.end(), std::less<int>());
+    saveArray(output, array);
+    auto memoryTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    ExternalSortOptions options;
+    options.memoryBudget = 16 << 20;
+    start = std::chrono::steady_clock::now();
+    externalSort<int>(input, output, std::less<int>(), options);
+    auto externalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    Array<int> sorted;
+    loadArray(output, sorted);
+    ASSERT_TRUE(std::equal(sorted.begin(), sorted.end(), array.begin()));
+    std::cout << "[          ] in memory: " << memoryTime.count() << " ms, external: " << externalTime.count() << " ms" << std::endl;
+
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
+
 TEST(Array, StringSort) {
     Array<std::string> array{ "sort", "array" };
     std::vector<std::string> std_vector{ "sort", "string", "array" };
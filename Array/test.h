@@ -7,6 +7,27 @@
 #include <gtest/gtest.h>
 #include "Array.h"
 #include "IntroSort.h"
+#include "Arena.h"
+#include "MappedArray.h"
+#include "AlignedAllocator.h"
+#include "SoAArray.h"
+#include "SegmentedArray.h"
+#include "ConcurrentArray.h"
+#include "CowArray.h"
+#include "ArrayIO.h"
+#include "ThreadPool.h"
+#include "ParallelSort.h"
+#include "SimdSort.h"
+#include "RadixSort.h"
+#include "Select.h"
+#include "ExternalSort.h"
+#include "PriorityQueue.h"
 #include <vector>
 #include <random>
 #include <string>
+#include <filesystem>
+#include <numeric>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <sstream>
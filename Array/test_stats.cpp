@@ -0,0 +1,55 @@
+//
+// test_stats.cpp
+//
+// Tests for the ArrayStats counters. They only exist when ARRAY_STATS is 1, which changes
+// Array itself, so this file is a separate test binary rather than part of test.cpp:
+//
+//     g++ -std=c++20 test_stats.cpp -lgtest -pthread -o test_stats
+//
+
+#define ARRAY_STATS 1
+
+#include <gtest/gtest.h>
+#include "Array.h"
+#include <sstream>
+#include <string>
+
+// Test case for allocation statistics
+TEST(Array, ArrayStatsTest) {
+    ArrayStats& stats = ArrayStatsRegistry::instance().forScope("ArrayStatsTest");
+    stats.reset();
+    {
+        ArrayStatsScope scope("ArrayStatsTest");
+        Array<int> array;
+        for (int i = 0; i < 100; i++) {
+            array.push_back(i);
+        }
+        // 16, 32, 64, 128: one allocation, then three regrowths through realloc
+        ASSERT_EQ(stats.allocations, 1);
+        ASSERT_EQ(stats.reallocations, 3);
+        ASSERT_EQ(stats.copies, 100);
+        ASSERT_EQ(stats.peakCapacity, 128 * sizeof(int));
+
+        Array<int> copy(array);
+        ASSERT_EQ(stats.copies, 200);
+        Array<int> moved(std::move(copy));
+        ASSERT_EQ(stats.moves, 0);
+    }
+    ASSERT_EQ(stats.wastedBytes % sizeof(int), 0);
+    ASSERT_GT(stats.wastedBytes, 28 * sizeof(int) - 1);
+
+    // outside the scope only the per-type counters move
+    uint64_t allocations = stats.allocations;
+    Array<int> other{ 1, 2, 3 };
+    ASSERT_EQ(stats.allocations, allocations);
+
+    std::ostringstream json;
+    dumpArrayStats(json);
+    ASSERT_NE(json.str().find("\"ArrayStatsTest\": {\"allocations\": 2"), std::string::npos);
+    ASSERT_NE(json.str().find("\"int\""), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}